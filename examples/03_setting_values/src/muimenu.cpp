@@ -143,14 +143,18 @@ void DisplayControls::_evt_button(ESPButton::event_t e, const EventMsg* m){
 void DisplayControls::_evt_encoder(ESPButton::event_t e, const EventMsg* m){
   LOGD(T_HID, printf, "_evt_encoder:%u, cnt:%d\n", e2int(e), m->cntr);
   // I do not need counter value here (for now), just figure out if it was increment or decrement via gpio which triggered and event
-  if (_inMenu && _menu)
+  if (_inMenu && _menu){
     _menu_encoder_action(m);
-  else {
-    if (m->gpio == BUTTON_INCR){
-      stub_text = incr;
-    } else {
-      stub_text = decr;
-    }    
+    // redraw screen only if menu has changed, i.e. spinning encoder at the end of slider's range changes nothing
+    if (_menu->needsRedraw())
+      _rr = true;
+    return;
+  }
+
+  if (m->gpio == BUTTON_INCR){
+    stub_text = incr;
+  } else {
+    stub_text = decr;
   }
   // redraw screen
   _rr = true;
@@ -385,6 +389,8 @@ void TemperatureSetup::_buildMenu(){
     addMuippItem(hslide, page);
     // make this item autoselected on this page
     pageAutoSelect(page, idx);
+    // bind scroll list label to the page id, so that list won't have to lookup page by name on each click
+    list->bindPage(i, page);
   }
 
   // ***
@@ -392,6 +398,7 @@ void TemperatureSetup::_buildMenu(){
   muiItemId page = makePage(menu_TemperatureOpts.at(menu_TemperatureOpts.size()-2), root_page);
   // add page Title element (still same one)
   addItemToPage(title2_id, page);
+  list->bindPage(menu_TemperatureOpts.size()-2, page);
   // create checkbox item
   addMuippItem(
     new MuiItem_U8g2_CheckBox(u8g2, nextIndex(), dictionary[D_SaveLast_box], save_work, [this](size_t v){ save_work = v; }, MAINSCREEN_FONT, 0, 35),
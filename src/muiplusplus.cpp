@@ -1,5 +1,6 @@
 #include "muiplusplus.hpp"
 #include <algorithm>
+#include <cstring>
 
 /*
 void MuiPage::add(MuiItem_pt&& item){
@@ -41,21 +42,84 @@ MuiPlusPlus::~MuiPlusPlus(){
 */
 muiItemId MuiPlusPlus::makePage(const char* name, muiItemId parent, item_opts options){
   ++_pages_index;
-  Serial.printf("makePage %u %s, parent %u\n", _pages_index, name, parent);
+  MUIPP_TRACE_I(page_make, _pages_index, parent);
   pages.emplace_back(_pages_index, name, parent, options);
+  _index_page(std::prev(pages.end()));
   return _pages_index;
 }
 
+mui_err_t MuiPlusPlus::addStaticPages(const MuiStaticPage* spages, size_t count){
+  for (size_t i = 0; i != count; ++i){
+    const MuiStaticPage &sp = spages[i];
+    if (!sp.id || _page_by_id(sp.id) != pages.end())
+      return mui_err_t::id_exist;
+
+    pages.emplace_back(sp.id, sp.name, sp.parent);
+    auto p = std::prev(pages.end());
+    (*p).items.assign_static(sp.items, sp.size);
+    (*p)._ring_reset();
+    (*p).autoSelect = sp.autoselect;
+    _index_page(p);
+    // dynamic pages must not reuse static ids
+    if (sp.id > _pages_index)
+      _pages_index = sp.id;
+  }
+  return mui_err_t::ok;
+}
+
+void MuiPlusPlus::_index_page(std::list<MuiPage>::iterator p){
+  muiItemId id = (*p).id;
+  if (id > _pages_idx.size())
+    _pages_idx.resize(id, pages.end());
+  _pages_idx[id - 1] = p;
+  // index page label, if label is already taken, first page keeps it
+  if ((*p).getName())
+    _pages_lbl.emplace((*p).getName(), id);
+}
+
+muiItemId MuiPlusPlus::pageIdByLabel(const char* label) const {
+  if (!label) return 0;
+  auto i = _pages_lbl.find(label);
+  // page might have been renamed after it was indexed, so indexed label is checked against page's current name
+  if (i != _pages_lbl.end()){
+    const char* name = (*_pages_idx[i->second - 1]).getName();
+    if (name && !std::strcmp(name, label))
+      return i->second;
+  }
+  // stale or missing label, compare against current names
+  auto p = std::find_if(pages.cbegin(), pages.cend(), [label](const MuiPage& pg){ return pg.getName() && !std::strcmp(pg.getName(), label); });
+  return p != pages.cend() ? (*p).id : 0;
+}
+
+mui_err_t MuiPlusPlus::setPageName(muiItemId page_id, const char* name){
+  auto p = _page_by_id(page_id);
+  if (p == pages.end()) return mui_err_t::id_err;
+  // drop old label if it was indexed for this page
+  if ((*p).getName()){
+    auto i = _pages_lbl.find((*p).getName());
+    if (i != _pages_lbl.end() && i->second == page_id)
+      _pages_lbl.erase(i);
+  }
+  (*p).setName(name);
+  _index_page(p);
+  // page title might be on screen
+  _redraw = true;
+  return mui_err_t::ok;
+}
+
 mui_err_t MuiPlusPlus::addMuippItem(MuiItem_pt item, muiItemId page_id){
-  Serial.printf("Adding item %u, page %u\n", item->id, page_id);
-  auto i = std::find_if(items.cbegin(), items.cend(), muipp::MatchID<MuiItem_pt>(item->id));
-  if ( i != items.cend() ){
-    Serial.printf("item:%u already exist!\n", item->id);
+  MUIPP_TRACE_I(item_add, item->id, page_id);
+  // id 0 means "no item" for lookups and navigation, i.e. exhausted nextIndex() pool
+  if (!item->id){
+    MUIPP_TRACE_E(item_noid);
+    return mui_err_t::id_err;
+  }
+  // add item to container, unless item with same id already exist
+  if ( !items.emplace(item->id, item).second ){
+    MUIPP_TRACE_E(item_exist, item->id);
     return mui_err_t::id_exist;
   }
-
-  // add item to container
-  items.emplace_back(item);
+  _ids.take(item->id);
 
   // link item with the specified page
   if (page_id){
@@ -79,18 +143,57 @@ mui_err_t MuiPlusPlus::addItemToPage(muiItemId item_id, muiItemId page_id){
   // check if such page exist
   auto p = _page_by_id(page_id);
   if ( p == pages.end() ){
-    Serial.printf("page:%u not found\n", page_id);
+    MUIPP_TRACE_E(page_notfound, page_id);
     return mui_err_t::id_err;
   }
 
   auto i = _item_by_id(item_id);
   if ( i == items.end() ){
-    Serial.printf("item:%u not found\n", item_id);
+    MUIPP_TRACE_E(item_notfound, item_id);
     return mui_err_t::id_err;
   }
-//
-  (*p).items.emplace_back((*i));
-  Serial.printf("bound item:%u to page:%u\n", item_id, page_id);
+
+  (*p).items.emplace_back((*i).second.get());
+  (*p)._ring_reset();
+  _redraw = true;
+  MUIPP_TRACE_I(item_bind, item_id, page_id);
+  return mui_err_t::ok;
+}
+
+mui_err_t MuiPlusPlus::removeMuippItem(muiItemId item_id){
+  auto i = _item_by_id(item_id);
+  if ( i == items.end() ) return mui_err_t::id_err;
+
+  bool refocus{false};
+  // unbind item from all pages
+  for (auto &p : pages){
+    for (size_t pos = 0; pos != p.items.size(); ){
+      if (p.items[pos]->id != item_id){
+        ++pos;
+        continue;
+      }
+      // invalidate page's cursor if it pointed to the item, or shift it to keep pointing to same item
+      if (p.currentItem == pos){
+        p.currentItem = MuiPage::npos;
+        p.itm_selected = false;
+        refocus = currentPage != pages.end() && &p == &(*currentPage);
+      } else if (p.currentItem != MuiPage::npos && p.currentItem > pos)
+        --p.currentItem;
+      p.items.erase(pos);
+      p._ring_reset();
+    }
+    if (p.autoSelect == item_id)
+      p.autoSelect = 0;
+  }
+
+  items.erase(i);
+  _ids.release(item_id);
+  _redraw = true;
+
+  // move focus to any other item if removed one was focused
+  if (refocus)
+    _any_focusable_item_on_a_page_b();
+
   return mui_err_t::ok;
 }
 
@@ -99,12 +202,15 @@ void MuiPlusPlus::menuStart(muiItemId page, muiItemId item){
   if( goPageId(page, item) != mui_err_t::ok){
     currentPage = pages.begin();
     (*currentPage).itm_selected = false;
+    _redraw = true;
   }
+  if (_snapshot_mode)
+    publishSnapshot();
 }
 
 
 mui_err_t MuiPlusPlus::goPageId(muiItemId page_id, muiItemId item_id){
-  Serial.printf("goPageId:%u,%u\n", page_id, item_id);
+  MUIPP_TRACE_D(page_go, page_id, item_id);
   auto p = _page_by_id(page_id);
   // check if no such page or page has no any items at all?
   if ( p == pages.end() || !(*p).items.size() ){
@@ -112,15 +218,19 @@ mui_err_t MuiPlusPlus::goPageId(muiItemId page_id, muiItemId item_id){
   }
 
   // unfocus/unselect and notify current item if it is defined
-  if ( (currentPage != pages.end()) && ((*currentPage).currentItem != (*currentPage).items.end()) && (*(*currentPage).currentItem)->focused ){
-    (*(*currentPage).currentItem)->focused = false;
-    (*(*currentPage).currentItem)->selected = false;
-    (*(*currentPage).currentItem)->muiEvent(mui_event(mui_event_t::unfocus));
+  if (currentPage != pages.end()){
+    MuiItem* itm = (*currentPage)._current();
+    if (itm && itm->focused){
+      itm->setFocused(false);
+      itm->setSelected(false);
+      itm->muiEvent(mui_event(mui_event_t::unfocus));
+    }
   }
 
   currentPage = p;
-  // invalidate current item iterator
-  (*currentPage).currentItem = (*currentPage).items.end();
+  _redraw = true;
+  // invalidate current item cursor
+  (*currentPage).currentItem = MuiPage::npos;
 
   // try to focus and select specified item on a page
   if ( item_id && (goItmId(item_id) == mui_err_t::ok) ) return mui_err_t::ok;
@@ -147,81 +257,310 @@ mui_err_t MuiPlusPlus::goPageLbl(const char* label){
 }
 
 mui_err_t MuiPlusPlus::goItmId(muiItemId item_id){
-  if (!item_id) return mui_err_t::id_err;
+  if (!item_id || currentPage == pages.end()) return mui_err_t::id_err;
+  MuiPage &page = *currentPage;
   // if I need to switch to specific item on a page, let's check if it is registered there
-  auto it = std::find_if( (*currentPage).items.begin(), (*currentPage).items.end(), muipp::MatchID<MuiItem_pt>(item_id) );
-  if (it == (*currentPage).items.end()) return mui_err_t::id_err;
+  auto it = std::find_if( page.items.begin(), page.items.end(), [item_id](const MuiItem* i){ return i->id == item_id; } );
+  if (it == page.items.end()) return mui_err_t::id_err;
 
   // OK, item is indeed found, we are happy, check if it is not static
   if ( (*it)->getConstant() )
     return mui_err_t::id_err;
 
   // unfocus and notify current item if it is defined and focused
-  if ( (currentPage != pages.end()) && ((*currentPage).currentItem != (*currentPage).items.end()) && (*(*currentPage).currentItem)->focused ){
-    (*(*currentPage).currentItem)->focused = false;
-    (*(*currentPage).currentItem)->muiEvent(mui_event(mui_event_t::unfocus));
+  MuiItem* cur = page._current();
+  if ( cur && cur->focused ){
+    cur->setFocused(false);
+    cur->muiEvent(mui_event(mui_event_t::unfocus));
   }
 
-  (*currentPage).currentItem = it;
+  page.currentItem = std::distance(page.items.begin(), it);
   // check if item is selectable, then focus on it and select it
   if ((*it)->getSelectable()){
-    (*currentPage).itm_selected = true;
-    (*(*currentPage).currentItem)->selected = true;
+    page.itm_selected = true;
+    (*it)->setSelected(true);
   }
   // update item's focus flag, we focus on it anyway, event if it' not selectable
-  (*it)->focused = true;
-  // notify item that it received focus
-  (*it)->muiEvent(mui_event(mui_event_t::focus));
+  (*it)->setFocused(true);
+  // notify item that it received focus, reply is handled like on any other focus move
+  _reply( (*it)->muiEvent(mui_event(mui_event_t::focus)) );
   return mui_err_t::ok;
 }
 
 
 void MuiPlusPlus::render(){
-  // won't run with no pages or items
-  if (!pages.size() || !items.size())
+  // in snapshot mode render items from the latest published states, menu's own members are not touched here
+  if (_snapshot_mode){
+    // reset flag before taking snapshot, so that snapshot published meanwhile would trigger next redraw
+    _snapshot_fresh = false;
+    const render_snapshot_t &s = _snapshot.front();
+    for (const auto &i : s.items)
+      i.first->renderState(s.page, i.second);
+    return;
+  }
+
+  // won't run with no pages
+  if (!pages.size() || currentPage == pages.end())
     return;
 
-  //Serial.printf("Render %u items on page:%u\n", (*currentPage).items.size(), (*currentPage).id);
+  // render each item on a page passing it a pointer to current page
+  const MuiPage* page = &(*currentPage);
+  for (MuiItem* itm : (*currentPage).items ){
+    itm->render(page);
+    itm->clearDirty();
+  }
+  _redraw = false;
+}
 
-  // render each item on a page
-  for (auto itm : (*currentPage).items ){
-    //Serial.printf("Render item:%u\n", id);
-    // render selected item passing it a reference to current page
-    (*itm).render(&(*currentPage));
+void MuiPlusPlus::render(const mui_rect& clip){
+  if (_snapshot_mode){
+    const bool top = clip.y <= 0;
+    if (top)
+      _snapshot_fresh = false;
+    const render_snapshot_t &s = top ? _snapshot.front() : _snapshot.current();
+    for (const auto &i : s.items){
+      const mui_rect &b = i.first->getBBox();
+      if (i.second.dirty || b.empty() || b.intersects(clip))
+        i.first->renderState(s.page, i.second);
+    }
+    return;
   }
 
+  if (!pages.size() || currentPage == pages.end())
+    return;
+
+  const MuiPage* page = &(*currentPage);
+  for (MuiItem* itm : (*currentPage).items ){
+    const mui_rect &b = itm->getBBox();
+    if (!itm->isDirty() && !b.empty() && !b.intersects(clip))
+      continue;
+    itm->render(page);
+    itm->clearDirty();
+  }
+  _redraw = false;
 }
 
-mui_event MuiPlusPlus::muiEvent(mui_event e){
-  Serial.printf("MPP event:%u\n", static_cast<uint32_t>(e.eid));
-  _evt_recursion = 0;
-  if (e.eid == mui_event_t::noop) return e;
+mui_rect MuiPlusPlus::renderPartial(const mui_rect& screen, mui_rect_cb clear){
+  if (!_snapshot_mode && (!pages.size() || currentPage == pages.end()))
+    return {};
 
-  // if focused Item on current page exist and active - pass navigation and value events there and process reply event
-  if ( (*currentPage).currentItem != (*currentPage).items.end() ){
-    // if item is selected then it could receive cursor + value events, it's resone will be forwarded to _menu_navigation() call
-    if ((*currentPage).itm_selected && (static_cast<size_t>(e.eid) < 100 || static_cast<size_t>(e.eid) >= 200) ){
-      return _menu_navigation( (* (*currentPage).currentItem )->muiEvent(e) );
+  // collect areas previously covered by dirty items
+  bool full = _snapshot_mode || _redraw;
+  mui_rect area;
+  if (!full){
+    for (const MuiItem* itm : (*currentPage).items){
+      if (!itm->isDirty()) continue;
+      // item's area is unknown, it could be anywhere on the screen
+      if (itm->getBBox().empty()){
+        full = true;
+        break;
+      }
+      area.unite(itm->getBBox());
     }
+  }
+
+  if (full){
+    if (clear) clear(screen);
+    render();
+    return screen;
+  }
+
+  area.intersect(screen);
+  if (area.empty())
+    return area;
+
+  const MuiPage* page = &(*currentPage);
+  // items might grow on redraw (i.e. wider value string), then repeat with extended area
+  // until it covers everything drawn, area only grows and is limited by the screen, so it will converge
+  for (;;){
+    if (clear) clear(area);
+    mui_rect drawn(area);
+    for (MuiItem* itm : (*currentPage).items){
+      const mui_rect &b = itm->getBBox();
+      if (!itm->isDirty() && !b.empty() && !b.intersects(area))
+        continue;
+      itm->render(page);
+      drawn.unite(itm->getBBox());
+    }
+    drawn.intersect(screen);
+    if (drawn == area)
+      break;
+    area = drawn;
+  }
+
+  for (MuiItem* itm : (*currentPage).items)
+    itm->clearDirty();
+  return area;
+}
+
+bool MuiPlusPlus::needsRedraw() const {
+  // in snapshot mode item flags are collected on publishing
+  if (_snapshot_mode) return _snapshot_fresh;
+  if (_redraw) return true;
+  if (!pages.size() || currentPage == pages.end()) return false;
+  for (const MuiItem* itm : (*currentPage).items)
+    if (itm->isDirty()) return true;
+  return false;
+}
+
+void MuiPlusPlus::setSnapshotMode(bool enable){
+  _snapshot_mode = enable;
+  if (enable){
+    _redraw = true;
+    publishSnapshot();
+  }
+}
 
-    // if item is not selectable, then it can still receive value and "enter" events without grabbing cursor navigation events, it's resone will be forwarded to _menu_navigation() call
-    if ((* (*currentPage).currentItem )->getSelectable() == false && (e.eid == mui_event_t::enter || static_cast<size_t>(e.eid) >= 200) ){
-      return _menu_navigation( (* (*currentPage).currentItem )->muiEvent(e) );
+void MuiPlusPlus::publishSnapshot(){
+  render_snapshot_t &s = _snapshot.back();
+  // vector keeps it's capacity, so no reallocations happen once slots has grown to the largest page
+  s.items.clear();
+  s.page = nullptr;
+  bool changed = _redraw;
+  _redraw = false;
+  if (pages.size() && currentPage != pages.end()){
+    s.page = &(*currentPage);
+    for (MuiItem* itm : (*currentPage).items){
+      s.items.emplace_back(itm, itm->getState());
+      // redraw flag is passed to render task with the state
+      if (itm->isDirty()){
+        changed = true;
+        itm->clearDirty();
+      }
     }
   }
+  _snapshot.publish();
+  // flag must be raised only after snapshot is available to render task
+  if (changed)
+    _snapshot_fresh = true;
+}
+
+mui_event MuiPlusPlus::muiEvent(mui_event e){
+  // re-entrant call from an item's event handler, outer call publishes the snapshot
+  const bool nested = _evt_draining;
+  mui_event r = _dispatch(e);
+  if (_snapshot_mode && !nested)
+    publishSnapshot();
+  return r;
+}
 
+mui_event MuiPlusPlus::_dispatch(mui_event e){
+  MUIPP_TRACE_D(menu_event, 0, static_cast<uint32_t>(e.eid));
+  if (e.eid == mui_event_t::noop) return e;
+  // called from an item's event handler while replies are being drained,
+  // replies are queued after pending ones and are drained by the outer call within it's budget
+  const bool nested = _evt_draining;
+  // replies are collected first and then drained in a loop
+  _evt_draining = true;
 
+  // if focused Item on current page exist and active - pass navigation and value events there and process reply event
+  MuiItem* itm = currentPage != pages.end() ? (*currentPage)._current() : nullptr;
+  // if item is selected then it could receive cursor + value events, it's resone will be forwarded to menu navigation
+  if (itm && (*currentPage).itm_selected && (static_cast<size_t>(e.eid) < 100 || static_cast<size_t>(e.eid) >= 200) ){
+    _reply( itm->muiEvent(e) );
+  }
+  // if item is not selectable, then it can still receive value and "enter" events without grabbing cursor navigation events, it's resone will be forwarded to menu navigation
+  // note: coalesced cursor moves (step) are never sent to unselected items, those are navigation events
+  else if (itm && itm->getSelectable() == false && (e.eid == mui_event_t::enter || (static_cast<size_t>(e.eid) >= 200 && e.eid != mui_event_t::step)) ){
+    _reply( itm->muiEvent(e) );
+  }
   // otherwise pass event to menu navigation function
-  if (static_cast<size_t>(e.eid) < 200)
-    return _menu_navigation(e);
+  else if (static_cast<size_t>(e.eid) < 200 || e.eid == mui_event_t::step)
+    _reply(e);
 
-  return {};
+  if (nested) return {};
+  return _drain_replies();
+}
+
+void MuiPlusPlus::_reply(mui_event e){
+  if (e.eid == mui_event_t::noop) return;
+  if (!_evt_replies.push(e)){
+    MUIPP_TRACE_E(menu_evt_drop, 0, static_cast<uint32_t>(e.eid));
+    return;
+  }
+  // not within event dispatch (i.e. goPageId() was called directly), handle it right away
+  if (!_evt_draining)
+    _drain_replies();
+}
+
+mui_event MuiPlusPlus::_drain_replies(){
+  _evt_draining = true;
+  mui_event e, r;
+  unsigned budget = _evt_budget;
+  while (_evt_replies.pop(e)){
+    if (!budget){
+      // budget is exhausted, discard whatever is left
+      MUIPP_TRACE_E(menu_evt_drop, 0, static_cast<uint32_t>(e.eid));
+      continue;
+    }
+    --budget;
+    mui_event out = _menu_navigation(e);
+    // keep first event that must be returned to the caller
+    if (r.eid == mui_event_t::noop)
+      r = out;
+  }
+  _evt_draining = false;
+  return r;
+}
+
+// returns step direction for cursor move event or 0 for any other event
+static int _move_delta(mui_event_t eid){
+  switch (eid){
+    case mui_event_t::moveUp :
+    case mui_event_t::moveLeft :
+      return -1;
+    case mui_event_t::moveDown :
+    case mui_event_t::moveRight :
+      return 1;
+    default:
+      return 0;
+  }
+}
+
+bool MuiPlusPlus::_pop_event(mui_event &e){
+  if (!_evt_queue.pop(e)) return false;
+  int delta = _move_delta(e.eid);
+  if (!_evt_coalesce || !delta) return true;
+
+  int count = delta;
+  bool merged = false;
+  while (const mui_event* next = _evt_queue.peek()){
+    int d = _move_delta(next->eid);
+    if (!d) break;
+    count += d;
+    merged = true;
+    _evt_queue.pop(e);
+  }
+
+  if (merged){
+    // moves cancelled each other
+    if (!count)
+      e = {};
+    else
+      e = mui_event(mui_event_t::step, count);
+  }
+  return true;
+}
+
+mui_event MuiPlusPlus::processEvents(){
+  mui_event e, r;
+  bool changed = false;
+  while (_pop_event(e)){
+    changed = true;
+    r = _dispatch(e);
+    if (r.eid != mui_event_t::noop)
+      break;
+  }
+  // publish once per batch of events
+  if (changed && _snapshot_mode)
+    publishSnapshot();
+  return r;
 }
 
 mui_event MuiPlusPlus::_menu_navigation(mui_event e){
-  // do not work on empty pages (for now), check recursion level
-  if ( (*currentPage).items.size() == 0 || (++_evt_recursion > MAX_NESTED_EVENTS) ) return {};
-  Serial.printf("_menu_navigation evt:%u, recursion:%u\n", static_cast<uint32_t>(e.eid), _evt_recursion);
+  // do not work on empty pages (for now)
+  if ( currentPage == pages.end() || (*currentPage).items.size() == 0 ) return {};
+  MUIPP_TRACE_D(menu_navigation, 0, static_cast<uint32_t>(e.eid));
 
   switch(e.eid){
     // cursor actions
@@ -238,18 +577,27 @@ mui_event MuiPlusPlus::_menu_navigation(mui_event e){
       _evt_nextItm();
       break;
 
+    // coalesced cursor moves, move focus by a number of items
+    case mui_event_t::step : {
+      for (int32_t n = e.param; n > 0; --n) _evt_nextItm();
+      for (int32_t n = e.param; n < 0; ++n) _evt_prevItm();
+      break;
+    }
+
     // enter/action event
-    case mui_event_t::enter :
+    case mui_event_t::enter : {
       // if focused item is selectable, mark it as 'selected', it will start stealing cursor events from menu navigator untill released
-      if ( currentPage == pages.end() || (*currentPage).currentItem == (*currentPage).items.end() || !(*(*currentPage).currentItem) ) break;    // if any of iterators are invalidated
-      if ((*(*currentPage).currentItem)->getSelectable()){
+      if ( currentPage == pages.end() ) break;
+      MuiItem* itm = (*currentPage)._current();
+      if ( !itm ) break;    // if cursor is invalidated
+      if (itm->getSelectable()){
         (*currentPage).itm_selected = true;
-        (*(*currentPage).currentItem)->selected = true;
+        itm->setSelected(true);
         // send "select" event to the item
-        // maybe I need recursive call to self here?
-        _menu_navigation( (*(*currentPage).currentItem)->muiEvent(mui_event(mui_event_t::select)) );
+        _reply( itm->muiEvent(mui_event(mui_event_t::select)) );
       }
       break;
+    }
 
     // go to previous page
     case mui_event_t::prevPage :
@@ -271,25 +619,14 @@ mui_event MuiPlusPlus::_menu_navigation(mui_event e){
     case mui_event_t::quitMenu :
       return mui_event(mui_event_t::quitMenu);
 
+    default:
+      break;
   }
 
   // no-op
   return {};
 }
 
-void MuiPlusPlus::_feedback_event(mui_event e){
-  Serial.printf("_feedback_event:%u\n", static_cast<uint32_t>(e.eid));
-  switch(e.eid){
-    case mui_event_t::prevPage :
-      _prev_page();
-      break;
-    case mui_event_t::goPageByName :
-      goPageLbl(static_cast<const char*>(e.arg) );
-      break;
-    // 
-  }
-}
-
 mui_event MuiPlusPlus::_prev_page(){
   // check if current page has any parent page 
   if ( (*currentPage).parent_page ){
@@ -302,13 +639,13 @@ mui_event MuiPlusPlus::_prev_page(){
 }
 
 mui_err_t MuiPlusPlus::pageAutoSelect(muiItemId page_id, muiItemId item_id){
-  Serial.printf("pageAutoSelect:%u,%u\n", page_id, item_id);
+  MUIPP_TRACE_I(page_autoselect, page_id, item_id);
   auto p = _page_by_id(page_id);
   if ( p == pages.cend() ){
     return mui_err_t::id_err;
   }
 
-  auto it = std::find_if( (*p).items.begin(), (*p).items.end(), muipp::MatchID<MuiItem_pt>(item_id) );
+  auto it = std::find_if( (*p).items.begin(), (*p).items.end(), [item_id](const MuiItem* i){ return i->id == item_id; } );
   if (it != (*p).items.end()){
     // OK, item is indeed found, we are happy
     (*p).autoSelect = item_id;
@@ -325,11 +662,12 @@ mui_event MuiPlusPlus::_evt_escape(){
   }
 
   // first unselect current item if it's selected and let menu navigation work on moving focus on other items
-  if ((*currentPage).itm_selected){
+  MuiItem* itm = (*currentPage)._current();
+  if ((*currentPage).itm_selected && itm){
     (*currentPage).itm_selected = false;
-    (*(*currentPage).currentItem)->selected = false;
+    itm->setSelected(false);
     // notify item that it lost selection
-    (*(*currentPage).currentItem)->muiEvent(mui_event(mui_event_t::unselect));
+    itm->muiEvent(mui_event(mui_event_t::unselect));
     return {};
   }
 
@@ -339,121 +677,121 @@ mui_event MuiPlusPlus::_evt_escape(){
 }
 
 uint32_t MuiPlusPlus::nextIndex(){
-  do {
-    ++_items_index;
-  } while(_item_by_id(_items_index) != items.end());
-
-  return _items_index;
+  return _ids.next();
 }
 
 mui_err_t MuiPlusPlus::_evt_nextItm(){
-  Serial.println("_evt_nextItm");
-  if ( !(*currentPage).items.size() || (*currentPage).currentItem == (*currentPage).items.end() ){
-    // invalid iterator, nothing on page we can work on
-    Serial.println("no valid items on a page!");
+  MUIPP_TRACE_D(item_next, (*currentPage).id);
+  MuiPage &page = *currentPage;
+  MuiItem* cur = page._current();
+  if ( !cur ){
+    // invalid cursor, nothing on page we can work on
+    MUIPP_TRACE_E(item_none, page.id);
     return mui_err_t::id_err;
   }
 
-  if (!(*(*currentPage).currentItem)->getConstant()){
-    (*(*currentPage).currentItem)->focused = false;
+  if (!cur->getConstant()){
+    cur->setFocused(false);
     // notify current item that it has lost focus
-    (*(*currentPage).currentItem)->muiEvent(mui_event(mui_event_t::unfocus));
-  }
-  // move focus on next item
-  while ( ++(*currentPage).currentItem != (*currentPage).items.end() ){
-    // stop on first non-const item
-    if ( !(*(*currentPage).currentItem)->getConstant() ) break;
+    cur->muiEvent(mui_event(mui_event_t::unfocus));
   }
 
-//  do{
-//    ++(*currentPage).currentItem;
-//  } while( ((*currentPage).currentItem != (*currentPage).items.end()) || (*(*currentPage).currentItem)->getConstant() );
-
-  if ((*currentPage).currentItem == (*currentPage).items.end())
-    return _any_focusable_item_on_a_page_b();
-  else {
-    // update focus flag
-    (*(*currentPage).currentItem)->focused = true;
-    // notify item that it received focus
-    _menu_navigation( (*(*currentPage).currentItem)->muiEvent(mui_event(mui_event_t::focus)) );
+  const auto &ring = page._focus_ring();
+  if (!ring.size()){
+    page.currentItem = MuiPage::npos;
+    return mui_err_t::id_err;
   }
-  return mui_err_t::ok;
+
+  // step to next focusable item, cycle to the first one at the end of the page
+  size_t rp = page._ring_index();
+  if (ring[rp] == page.currentItem)
+    ++rp;
+  return _focus_ring_item(rp == ring.size() ? 0 : rp);
 }
 
 mui_err_t MuiPlusPlus::_evt_prevItm(){
-  Serial.println("_evt_prevItm");
-  if ( !(*currentPage).items.size() || (*currentPage).currentItem == (*currentPage).items.end() ){
-    // invalid iterator, nothing on page we can work on
-    Serial.println("no valid items on a page!");
+  MUIPP_TRACE_D(item_prev, (*currentPage).id);
+  MuiPage &page = *currentPage;
+  MuiItem* cur = page._current();
+  if ( !cur ){
+    // invalid cursor, nothing on page we can work on
+    MUIPP_TRACE_E(item_none, page.id);
     return mui_err_t::id_err;
   }
 
-  if (!(*(*currentPage).currentItem)->getConstant()){
-    (*(*currentPage).currentItem)->focused = false;
+  if (!cur->getConstant()){
+    cur->setFocused(false);
     // notify current item that it has lost focus
-    (*(*currentPage).currentItem)->muiEvent(mui_event(mui_event_t::unfocus));
-  }
-  // move focus on prev item (if we are at first item, cycle to the last)
-  if ((*currentPage).currentItem == (*currentPage).items.begin())
-    (*currentPage).currentItem = std::prev( (*currentPage).items.end() );
-
-  while ( --(*currentPage).currentItem != (*currentPage).items.begin()){
-    Serial.println("p1");
-    // stop on first non-const item
-    if ( !(*(*currentPage).currentItem)->getConstant() ) break;
-  }
-
-//  do {
-//    Serial.println("p1");
-//    --(*currentPage).currentItem;
-//  } while( (*currentPage).currentItem != (*currentPage).items.begin() || (*(*currentPage).currentItem)->getConstant() );
-    Serial.println("p2");
-
-  // check if last iterator is reached head of list and still we have constant element that we can't focus on
-  if ((*currentPage).currentItem == (*currentPage).items.begin() && (*(*currentPage).currentItem)->getConstant())
-    return _any_focusable_item_on_a_page_e();
-  else {
-    Serial.println("p4");
-    // update focus flag
-    (*(*currentPage).currentItem)->focused = true;
-    // notify item that it received focus
-    _menu_navigation( (*(*currentPage).currentItem)->muiEvent(mui_event(mui_event_t::focus)) );
+    cur->muiEvent(mui_event(mui_event_t::unfocus));
+  }
+
+  const auto &ring = page._focus_ring();
+  if (!ring.size()){
+    page.currentItem = MuiPage::npos;
+    return mui_err_t::id_err;
   }
+
+  // step to previous focusable item, cycle to the last one at the head of the page
+  size_t rp = page._ring_index();
+  return _focus_ring_item(rp ? rp - 1 : ring.size() - 1);
+}
+
+mui_err_t MuiPlusPlus::_focus_ring_item(size_t ring_pos){
+  MuiPage &page = *currentPage;
+  page._ring_pos = ring_pos;
+  page.currentItem = page._ring[ring_pos];
+  MuiItem* itm = page.items[page.currentItem];
+  // update focus flag
+  itm->setFocused(true);
+  // notify item that it received focus
+  _reply( itm->muiEvent(mui_event(mui_event_t::focus)) );
   return mui_err_t::ok;
 }
 
 mui_err_t MuiPlusPlus::_any_focusable_item_on_a_page_b(){
-  Serial.println("_any_focusable_item_on_a_page_b");
-  for (auto it = (*currentPage).items.begin(); it != (*currentPage).items.end(); ++it){
-    if ( (*it)->getConstant() )
-      continue;
-    (*currentPage).currentItem = it;
-    // update new item's focus flag
-    (*it)->focused = true;
-    // notify item that it received focus
-    (*it)->muiEvent(mui_event(mui_event_t::focus));
-    return mui_err_t::ok;
+  MuiPage &page = *currentPage;
+  if (!page._focus_ring().size()){
+    // invalidate cursor
+    page.currentItem = MuiPage::npos;
+    return mui_err_t::id_err;
   }
-
-  return mui_err_t::id_err;
+  return _focus_ring_item(0);
 }
 
 mui_err_t MuiPlusPlus::_any_focusable_item_on_a_page_e(){
-  Serial.println("_any_focusable_item_on_a_page_e");
-  if ( !(*currentPage).items.size())   return mui_err_t::id_err;
-  for (auto it = std::prev( (*currentPage).items.end() ); it != (*currentPage).items.begin(); --it){
-    if ( (*it)->getConstant() )
-      continue;
-    (*currentPage).currentItem = it;
-    // update new item's focus flag
-    (*it)->focused = true;
-    // notify item that it received focus
-    (*it)->muiEvent(mui_event(mui_event_t::focus));
-    return mui_err_t::ok;
+  MuiPage &page = *currentPage;
+  if (!page._focus_ring().size()){
+    // invalidate cursor
+    page.currentItem = MuiPage::npos;
+    return mui_err_t::id_err;
   }
+  return _focus_ring_item(page._ring.size() - 1);
+}
 
-  // invalidate itrator
-  (*currentPage).items.end();
-  return mui_err_t::id_err;
+//  ***
+//  MuiPage
+
+const std::vector<size_t>& MuiPage::_focus_ring(){
+  if (_ring_gen == _opts_gen) return _ring;
+
+  _ring.clear();
+  for (size_t pos = 0; pos != items.size(); ++pos){
+    if (!items[pos]->getConstant())
+      _ring.push_back(pos);
+  }
+  _ring_gen = _opts_gen;
+  _ring_pos = 0;
+  return _ring;
 }
 
+size_t MuiPage::_ring_index(){
+  // cached position is valid unless cursor was moved bypassing the ring
+  if (_ring_pos < _ring.size() && _ring[_ring_pos] == currentItem)
+    return _ring_pos;
+
+  _ring_pos = std::lower_bound(_ring.begin(), _ring.end(), currentItem) - _ring.begin();
+  // cursor is beyond last focusable item
+  if (_ring_pos == _ring.size())
+    _ring_pos = 0;
+  return _ring_pos;
+}
@@ -2,14 +2,24 @@
 
 #include <list>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 #include "muipp_tpl.hpp"
+#include "muipp_trace.hpp"
 //#include <string_view>
 //#include "clib/mui.h"
 //#include "clib/mui_u8g2.h"
 #include "Arduino.h"
 
+// default number of reply events that could be handled during single event dispatch, see MuiPlusPlus::setEventBudget()
+#ifndef MAX_NESTED_EVENTS
 #define MAX_NESTED_EVENTS 5
+#endif
+
+// size of value storage in item's render snapshot state, must fit any item value copied with mui_item_state::set()
+#ifndef MUIPP_STATE_VALUE_SIZE
+#define MUIPP_STATE_VALUE_SIZE  8
+#endif
 
 enum class mui_err_t {
   ok = 0,
@@ -84,11 +94,91 @@ struct item_opts {
   bool constant{false};
 };
 
+/**
+ * @brief rectangular screen area, empty if width or height is 0
+ */
+struct mui_rect {
+  int16_t x{0}, y{0};
+  int16_t w{0}, h{0};
+
+  mui_rect() = default;
+  mui_rect(int x, int y, int w, int h) : x(x), y(y), w(w), h(h) {}
+
+  bool empty() const { return w <= 0 || h <= 0; }
+
+  bool intersects(const mui_rect& r) const {
+    return !empty() && !r.empty() && x < r.x + r.w && r.x < x + w && y < r.y + r.h && r.y < y + h;
+  }
+
+  // returns true if r is fully inside this rect
+  bool contains(const mui_rect& r) const {
+    return r.empty() || (!empty() && r.x >= x && r.y >= y && r.x + r.w <= x + w && r.y + r.h <= y + h);
+  }
+
+  // extend rect to cover r
+  mui_rect& unite(const mui_rect& r){
+    if (r.empty()) return *this;
+    if (empty()) return *this = r;
+    int x2 = x + w > r.x + r.w ? x + w : r.x + r.w;
+    int y2 = y + h > r.y + r.h ? y + h : r.y + r.h;
+    if (r.x < x) x = r.x;
+    if (r.y < y) y = r.y;
+    w = x2 - x;
+    h = y2 - y;
+    return *this;
+  }
+
+  // crop rect to fit into r
+  mui_rect& intersect(const mui_rect& r){
+    int x2 = x + w < r.x + r.w ? x + w : r.x + r.w;
+    int y2 = y + h < r.y + r.h ? y + h : r.y + r.h;
+    if (r.x > x) x = r.x;
+    if (r.y > y) y = r.y;
+    w = x2 > x ? x2 - x : 0;
+    h = y2 > y ? y2 - y : 0;
+    return *this;
+  }
+
+  bool operator==(const mui_rect& r) const { return x == r.x && y == r.y && w == r.w && h == r.h; }
+  bool operator!=(const mui_rect& r) const { return !(*this == r); }
+};
+
+/**
+ * @brief copy of item's state that is required to render it
+ * it is captured by event task when render snapshot is published and is consumed by render task,
+ * so item could be drawn without reading it's members that are being changed by event task
+ */
+struct mui_item_state {
+  bool focused{false};
+  bool selected{false};
+  // item's visible state has changed since last render
+  bool dirty{false};
+  // item specific value copy
+  alignas(8) uint8_t value[MUIPP_STATE_VALUE_SIZE]{};
+
+  template <typename T>
+  void set(const T& v){
+    static_assert(std::is_trivially_copyable_v<T> && sizeof(T) <= MUIPP_STATE_VALUE_SIZE, "value does not fit into mui_item_state");
+    std::memcpy(value, &v, sizeof(T));
+  }
+
+  template <typename T>
+  T get() const {
+    static_assert(std::is_trivially_copyable_v<T> && sizeof(T) <= MUIPP_STATE_VALUE_SIZE, "value does not fit into mui_item_state");
+    T v;
+    std::memcpy(&v, value, sizeof(T));
+    return v;
+  }
+};
+
 
 // aliases
 
 // MuiItem event callback type
-using mui_event_cb = std::function<mui_event (mui_event e)>;
+using mui_event_cb = muipp::delegate<mui_event (mui_event e)>;
+
+// callback that accepts screen area, i.e. to clear it before redrawing
+using mui_rect_cb = muipp::delegate<void (const mui_rect& area)>;
 
 
 
@@ -103,6 +193,22 @@ protected:
   // Item properties struct
   item_opts opt;
 
+  // generation counter for items options, changed each time any item changes it's focus-related options
+  inline static uint32_t _opts_gen{1};
+
+  /**
+   * @brief signal that item's focus-related options has changed
+   * derived classes that override setConstant() or compute getConstant() dynamically must call it on change,
+   * so that pages could rebuild it's focus order
+   */
+  static void optionsChanged(){ if (!++_opts_gen) ++_opts_gen; }
+
+  // item's visible state has changed and it needs to be redrawn, new items are always drawn first time
+  bool _dirty{true};
+
+  // screen area covered by the item at last render, it should be updated by items on each render
+  mui_rect _bbox;
+
 public:
   // numeric identificator of item
   const muiItemId  id;
@@ -119,6 +225,31 @@ public:
    */
   bool selected{false};
 
+  // set focus flag, item is marked for redraw if flag changes
+  void setFocused(bool v){ if (focused != v){ focused = v; _dirty = true; } }
+
+  // set selection flag, item is marked for redraw if flag changes
+  void setSelected(bool v){ if (selected != v){ selected = v; _dirty = true; } }
+
+  /**
+   * @brief mark item for redraw
+   * items must call it when their visible state changes on events,
+   * user code should call it when data displayed via callbacks changes
+   */
+  void invalidate(){ _dirty = true; }
+
+  // returns true if item's visible state has changed since last render
+  bool isDirty() const { return _dirty; }
+
+  // reset redraw flag, it is called by MuiPlusPlus when item is rendered
+  void clearDirty(){ _dirty = false; }
+
+  /**
+   * @brief screen area covered by the item at last render
+   * empty if item does not draw anything or does not track it's area
+   */
+  const mui_rect& getBBox() const { return _bbox; }
+
   /**
    * @brief event that could be returned on Item receiving escape event
    * could be changed for i.e. prevPage, etc...
@@ -126,12 +257,13 @@ public:
   mui_event_t on_escape{ mui_event_t::escape};
 
 
-  MuiItem(muiItemId id, const char* name = nullptr, item_opts options = item_opts()) : id(id), name(name), opt(options) {};
-  virtual ~MuiItem(){ Serial.printf("MuiItem d-tor, id:%u\n", id); };
+  MuiItem(muiItemId id, const char* name = nullptr, item_opts options = item_opts()) : name(name), opt(options), id(id) {};
+  virtual ~MuiItem(){ MUIPP_TRACE_I(item_dtor, id); };
 
   const char* getName() const { return name; };
 
-  const char* setName(const char* newname) { name = newname; return name; };
+  // change item's name, item is marked for redraw
+  const char* setName(const char* newname) { name = newname; _dirty = true; return name; };
 
   /**
    * @brief returns true if Item can be selected on a page
@@ -146,7 +278,7 @@ public:
 
   virtual bool getConstant() const { return opt.constant; }
 
-  virtual void setConstant(bool value) { opt.constant = value; }
+  virtual void setConstant(bool value) { if (opt.constant != value){ opt.constant = value; optionsChanged(); } }
 
   //void setEventCallBack(mui_event_cb c){ cb = c; };
 
@@ -164,6 +296,24 @@ public:
    * @param page 
    */
   virtual void render(const MuiItem* parent){};
+
+  /**
+   * @brief capture item's state required for rendering
+   * items that render some mutable value should override it and store a copy of the value with mui_item_state::set()
+   * 
+   * @return mui_item_state 
+   */
+  virtual mui_item_state getState() const { mui_item_state s; s.focused = focused; s.selected = selected; s.dirty = _dirty; return s; }
+
+  /**
+   * @brief render item from a previously captured state
+   * it is called by MuiPlusPlus in snapshot mode, implementation must not read item's members that are changed by events,
+   * by default it falls back to render()
+   * 
+   * @param parent 
+   * @param state item's state captured with getState()
+   */
+  virtual void renderState(const MuiItem* parent, const mui_item_state& state){ render(parent); };
 };
 
 class MuiItem_Uncontrollable : public MuiItem {
@@ -189,16 +339,39 @@ using MuiItem_pt = std::shared_ptr<MuiItem>;
  */
 class MuiPage : public MuiItem {
   friend class MuiPlusPlus;
-  std::list<MuiItem_pt> items;
-  std::list<MuiItem_pt>::iterator currentItem;
+  // items on a page, objects are owned by MuiPlusPlus container (or static)
+  muipp::cow_vector<MuiItem*> items;
+  // position of focused item in 'items', npos if none
+  size_t currentItem{npos};
   // if itm_selected is true, than focused item will receive events from a cursor
   bool itm_selected{false};
   // parent page id (zero -> no parent page)
   muiItemId parent_page;
-  
+  // focus order, positions of focusable (non-constant) items in 'items'
+  std::vector<size_t> _ring;
+  // position of focused item in a focus ring
+  size_t _ring_pos{0};
+  // items options generation the ring was built for, 0 - ring must be rebuilt
+  uint32_t _ring_gen{0};
+
+  // returns focused item or nullptr if none
+  MuiItem* _current() const { return currentItem < items.size() ? items[currentItem] : nullptr; }
+
+  // returns focus ring, rebuilds it if page membership or items options has changed
+  const std::vector<size_t>& _focus_ring();
+
+  // returns position in a focus ring for the focused item, or for the next focusable item if current is not focusable
+  size_t _ring_index();
+
+  // invalidate focus ring on page membership change
+  void _ring_reset(){ _ring_gen = 0; }
+
 public:
+  // invalid cursor position
+  static constexpr size_t npos = static_cast<size_t>(-1);
+
   MuiPage(muiItemId id, const char* name = nullptr, muiItemId parent = 0, item_opts options = item_opts())
-    : MuiItem(id, name, options), parent_page(parent) { currentItem = items.end(); };
+    : MuiItem(id, name, options), parent_page(parent) {};
 
   /**
    * @brief specifies if there is an item on a page that will
@@ -214,6 +387,49 @@ public:
 
 
 
+/**
+ * @brief static page descriptor
+ * describes a page with a fixed set of items that are defined at compile time,
+ * could be declared as constexpr and placed in flash along with page's items array
+ */
+struct MuiStaticPage {
+  // page id
+  muiItemId id;
+  // page label
+  const char* name;
+  // parent page id (zero -> no parent page)
+  muiItemId parent;
+  // item that is focused and selected when switching to this page (zero -> none)
+  muiItemId autoselect;
+  // page items
+  MuiItem* const* items;
+  size_t size;
+};
+
+/**
+ * @brief make static page descriptor
+ * i.e.
+ *  static MuiItem_U8g2_PageTitle title(u8g2, 1, font);
+ *  static MuiItem_U8g2_CheckBox box(u8g2, 2, "Enable", false);
+ *  constexpr MuiItem* page_items[] = { &title, &box };
+ *  constexpr MuiStaticPage menu[] = { mui_static_page(1, "Main", page_items) };
+ * 
+ * @note static items are not tracked by id allocator, if static and dynamic items are mixed on same pages,
+ * pick static item ids from user range [MUIPP_USER_ID_BASE, ...) to avoid clashing with nextIndex() ids
+ * 
+ * @param id page id, must be unique among all pages
+ * @param name page label, must persist while menu exist
+ * @param items array of pointers to items, items and array must persist while menu exist
+ * @param parent parent page id
+ * @param autoselect autoselect item id
+ */
+template <size_t N>
+constexpr MuiStaticPage mui_static_page(muiItemId id, const char* name, MuiItem* const (&items)[N], muiItemId parent = 0, muiItemId autoselect = 0){
+  return { id, name, parent, autoselect, items, N };
+}
+
+
+
 /**
  * @brief MuiPlusPlus container onject
  * it aggregates various items derivates, organize it into pages
@@ -222,17 +438,60 @@ public:
  */
 class MuiPlusPlus {
 
-  // sequence number for the items
-  muiItemId _items_index{0};
+  // id allocator for the items
+  muipp::IdAllocator _ids;
+  // sequence number for the pages
   muiItemId _pages_index{0};
 
 //protected:
-  std::list<MuiItem_pt> items;
+  // arena for items owned by container, must outlive all other containers referencing the items
+  muipp::Arena _arena;
+  // items container, hashed by item id
+  std::unordered_map<muiItemId, MuiItem_pt> items;
   std::list<MuiPage> pages;
   std::list<MuiPage>::iterator currentPage;
+  // page index, page ids are sequential, so position in vector is (id - 1)
+  std::vector< std::list<MuiPage>::iterator > _pages_idx;
+  // page labels index, labels are hashed once on page creation
+  std::unordered_map<std::string_view, muiItemId> _pages_lbl;
+
+  // reply events pending for menu navigation, drained iteratively by _drain_replies()
+  muipp::spsc_queue<mui_event, MUIPP_REPLY_QUEUE_SIZE> _evt_replies;
+  // max number of reply events handled per dispatch
+  unsigned _evt_budget{MAX_NESTED_EVENTS};
+  // reply queue is being drained
+  bool _evt_draining{false};
+
+  // menu structure has changed (page switched, items added/removed), whole screen must be redrawn
+  bool _redraw{true};
+  // snapshot with changes was published and not yet rendered, set by event task and cleared by render task
+  std::atomic<bool> _snapshot_fresh{false};
+
+  // events posted by input tasks, drained by processEvents()
+  muipp::spsc_queue<mui_event, MUIPP_EVENT_QUEUE_SIZE> _evt_queue;
+
+  // merge consecutive queued cursor moves into a single 'step' event
+  bool _evt_coalesce{false};
+
+  // items on current page with their states, published by event task for the render task
+  struct render_snapshot_t {
+    const MuiPage* page{nullptr};
+    std::vector< std::pair<MuiItem*, mui_item_state> > items;
+  };
+  muipp::triple_buffer<render_snapshot_t> _snapshot;
+  bool _snapshot_mode{false};
+
+  // process event without publishing render snapshot
+  mui_event _dispatch(mui_event e);
 
-  // event callback level
-  unsigned _evt_recursion{0};
+  /**
+   * @brief take next event from the queue, if coalescing is enabled
+   * consecutive cursor moves are merged into a single mui_event_t::step event with signed count in param
+   * 
+   * @param e event to fill
+   * @return true if event was taken
+   */
+  bool _pop_event(mui_event &e);
 
   /**
    * @brief find page by it's id
@@ -240,30 +499,43 @@ class MuiPlusPlus {
    * @param id 
    * @return std::list<MuiPage>::iterator 
    */
-  std::list<MuiPage>::iterator _page_by_id(muiItemId id){ return std::find_if(pages.begin(), pages.end(), muipp::MatchPageID<MuiPage>(id)); }
+  std::list<MuiPage>::iterator _page_by_id(muiItemId id){ return (id && id <= _pages_idx.size()) ? _pages_idx[id - 1] : pages.end(); }
 
   /**
-   * @brief find item byt it's id
+   * @brief find page by it's label
    * 
-   * @param id 
-   * @return std::list<MuiItem_pt>::iterator 
+   * @param label 
+   * @return std::list<MuiPage>::iterator 
    */
-  std::list<MuiPage>::iterator _page_by_label(const char* label){ return std::find_if(pages.begin(), pages.end(), muipp::MatchLabel<MuiPage>(label)); }
+  std::list<MuiPage>::iterator _page_by_label(const char* label){ return _page_by_id(pageIdByLabel(label)); }
 
   /**
    * @brief find item by it's id
    * 
    * @param id 
-   * @return std::list<MuiItem_pt>::iterator 
+   * @return std::unordered_map<muiItemId, MuiItem_pt>::iterator 
    */
-  std::list<MuiItem_pt>::iterator _item_by_id(muiItemId id){ return std::find_if(items.begin(), items.end(), muipp::MatchID<MuiItem_pt>(id)); }
+  std::unordered_map<muiItemId, MuiItem_pt>::iterator _item_by_id(muiItemId id){ return items.find(id); }
+
+  // add page to id and label indexes
+  void _index_page(std::list<MuiPage>::iterator p);
 
 
   /**
-   * @brief handler for an event that item may return in reply to input event
+   * @brief queue event for menu navigation
+   * items' reply events are not handled recursively, those are queued and processed in order by _drain_replies(),
+   * if called outside of event dispatch, queue is drained immediately
    * 
+   * @param e 
    */
-  void _feedback_event(mui_event e);
+  void _reply(mui_event e);
+
+  /**
+   * @brief process queued reply events until queue is empty or event budget is exhausted
+   * 
+   * @return mui_event first non-noop event that should be returned to the caller (i.e. quitMenu)
+   */
+  mui_event _drain_replies();
 
   /**
    * @brief hanles event on navigating the menu
@@ -287,8 +559,13 @@ public:
 
   /**
    * @brief generate next available id for the item
+   * returned id is reserved until item with that id is removed.
+   * Ids are never generated in user range [MUIPP_USER_ID_BASE, ...), so it is safe to use those for own items
    * 
-   * @return uint32_t 
+   * @note 0 is returned when id pool is exhausted, it is not a valid item id and addMuippItem()/makeItem()
+   * reject items with id 0, so check returned value before creating an item
+   * 
+   * @return uint32_t, 0 if no more ids available
    */
   uint32_t nextIndex();
 
@@ -302,6 +579,21 @@ public:
    */
   muiItemId makePage(const char* name = nullptr, muiItemId parent = 0, item_opts options = item_opts());
 
+  /**
+   * @brief load pages defined at compile time
+   * pages will reference static items arrays and items directly, items are not owned by container,
+   * are not added to container's items index and do not take any ids from nextIndex() pool
+   * @note static page's items list is copied to RAM only if it is modified later with addItemToPage() or removeMuippItem()
+   * 
+   * @param spages array of static page descriptors, could be in flash
+   * @param count number of pages
+   * @return mui_err_t id_exist if any of page ids is already taken, pages loaded before that are kept
+   */
+  mui_err_t addStaticPages(const MuiStaticPage* spages, size_t count);
+
+  template <size_t N>
+  mui_err_t addStaticPages(const MuiStaticPage (&spages)[N]){ return addStaticPages(spages, N); }
+
   /**
    * @brief assign item on a page as "autoselecting"
    * i.t. this item will get focus and autoselected when switching to this page
@@ -312,23 +604,120 @@ public:
    */
   mui_err_t pageAutoSelect(muiItemId page_id, muiItemId item_id);
 
+  /**
+   * @brief resolve page id by page's label
+   * if more than one page has same label, the first created page is returned.
+   * Labels are looked up in an index, if label is not found there (i.e. page was renamed with MuiItem::setName()),
+   * pages' current names are scanned
+   * @param label page label
+   * @return muiItemId page id or 0 if no page with such label exist
+   */
+  muiItemId pageIdByLabel(const char* label) const;
+
+  /**
+   * @brief rename a page and update page labels index
+   * pages should be renamed this way rather than with MuiItem::setName(), index keeps a reference to the old name
+   * otherwise, so the old name string must outlive the container
+   * 
+   * @param page_id page id
+   * @param name new page name, string is NOT copied, pointer must persist for page's life-time
+   * @return mui_err_t id_err if page does not exist
+   */
+  mui_err_t setPageName(muiItemId page_id, const char* name);
+
+  /**
+   * @brief add item to container and optionally bind it to a page
+   * 
+   * @param item item to add, it's id must be unique and non-zero
+   * @param page_id page to bind item to, 0 - do not bind
+   * @return mui_err_t id_err if item's id is 0 (i.e. taken from exhausted nextIndex()) or page does not exist,
+   * id_exist if item with same id is already in container
+   */
   mui_err_t addMuippItem(MuiItem_pt item, muiItemId page_id = 0);
 
   mui_err_t addMuippItem(MuiItem *item, muiItemId page_id = 0);
 
+  /**
+   * @brief construct a new item of type T in container's own arena memory and add it to the container
+   * such items are not reference-counted, container owns it and all items are released at once
+   * when container is destroyed. Use addItemToPage() to bind created item to pages
+   * @note arena memory is not reclaimed on removeMuippItem(), only when container is destroyed
+   * 
+   * @param args arguments for T's constructor
+   * @return T* pointer to created item or nullptr if item's id is 0 or already exist, or out of memory
+   */
+  template <class T, class... Args>
+  T* makeItem(Args&&... args);
+
   //mui_err_t addMuippItem(MuiItem&& item, muiItemId page_id = 0);//{ addMuippItem( std::make_unique<MuiItem_pt>(std::move(item)), page_id); };
 
   mui_err_t addItemToPage(muiItemId item_id, muiItemId page_id);
 
+  /**
+   * @brief remove item from container and unbind it from all pages
+   * item's id is released and could be reused by nextIndex()
+   * 
+   * @param item_id 
+   * @return mui_err_t 
+   */
+  mui_err_t removeMuippItem(muiItemId item_id);
+
   /**
    * @brief event sink
    * will receive events to menu current page / selected item, etc...
+   * @note it could be called from an item's muiEvent() handler, such event is passed to the item right away,
+   * but menu navigation for it's replies is deferred until replies already pending are handled,
+   * it shares the budget of the outer call and nested call always returns noop, first result is returned by the outer call
    * 
    * @param e input event struct
    * @return mui_event responce event struct
    */
   mui_event muiEvent(mui_event e);
 
+  /**
+   * @brief post event to menu's queue, it will be processed later on with processEvents() call
+   * it is safe to call from an ISR or other task than the one calling processEvents()/render(),
+   * but there must be only one producer task posting events
+   * 
+   * @param e input event struct
+   * @return true if event was queued
+   * @return false if queue is full
+   */
+  bool postEvent(mui_event e){ return _evt_queue.push(e); }
+
+  /**
+   * @brief process events queued with postEvent()
+   * should be called from the same task that calls render(), it stops on first non-noop reply event
+   * (i.e. quitMenu) and returns it, remaining events are left in a queue
+   * 
+   * @return mui_event responce event struct
+   */
+  mui_event processEvents();
+
+  // check if there are events posted with postEvent() and not processed yet
+  bool eventsPending() const { return !_evt_queue.empty(); }
+
+  /**
+   * @brief enable/disable coalescing of queued cursor events
+   * when enabled, processEvents() merges a run of consecutive moveUp/moveLeft/moveDown/moveRight events
+   * into a single mui_event_t::step event with signed count in mui_event::param (negative for up/left).
+   * Selected items receive it as a multi-step value change, otherwise menu navigator moves focus by count items.
+   * A single (not merged) move is passed as-is
+   * @note custom items that grab cursor events should handle mui_event_t::step if coalescing is enabled
+   * 
+   * @param enable 
+   */
+  void setEventCoalescing(bool enable){ _evt_coalesce = enable; }
+
+  /**
+   * @brief set max number of reply events handled per dispatched event
+   * items could reply to events with other events (i.e. focus -> moveDown), those are queued and processed iteratively,
+   * budget limits chains of replies that would never end, events beyond budget are dropped
+   * 
+   * @param budget number of reply events, default is MAX_NESTED_EVENTS
+   */
+  void setEventBudget(unsigned budget){ _evt_budget = budget; }
+
   /**
    * @brief switch to specified page with id 'page' and (optionally) item id
    * 
@@ -358,6 +747,66 @@ public:
   // render menu on screen
   void render();
 
+  /**
+   * @brief render only items which area intersect with clip rectangle
+   * it is meant for page buffer mode of display libs, where the screen is drawn in horizontal stripes,
+   * i.e. u8g2 firstPage()/nextPage() loop. Dirty items and items with unknown area are always rendered,
+   * so their area is refreshed on the top stripe and is valid for the following stripes.
+   * @note in snapshot mode new snapshot is picked up only for the clip at the top of the screen (y == 0),
+   * so all the stripes of the frame are drawn from the same snapshot
+   * 
+   * @param clip area of the screen being drawn
+   */
+  void render(const mui_rect& clip);
+
+  /**
+   * @brief check if screen needs to be redrawn
+   * returns true if any event since last render() call has changed visible state of the menu, i.e. page switched,
+   * focus moved or some item on current page has changed it's value. If false, render() would produce exactly the same frame
+   * and could be skipped.
+   * @note items displaying data provided by callbacks can't track it's changes, user code should call invalidate()
+   * for the menu or MuiItem::invalidate() for the item when such data changes
+   * 
+   * @return true if render() is needed
+   */
+  bool needsRedraw() const;
+
+  // force redraw on next needsRedraw() check
+  void invalidate(){ _redraw = true; }
+
+  /**
+   * @brief render only those items on current page that have changed since last render
+   * union of dirty items areas (at previous and current render) is cleared with a callback and all items
+   * that are dirty or intersect that area are redrawn in page order. Whole page is redrawn if page was switched,
+   * if a dirty item does not know it's area yet, or in snapshot mode.
+   * @note items that do not track their area (have empty bbox) are redrawn each time
+   * 
+   * @param screen full screen area
+   * @param clear callback to clear screen area before it is redrawn
+   * @return mui_rect area of the screen that has been redrawn, empty if nothing has changed
+   */
+  mui_rect renderPartial(const mui_rect& screen, mui_rect_cb clear);
+
+  /**
+   * @brief enable/disable render snapshot mode
+   * in snapshot mode muiEvent() and processEvents() publish a copy of current page's items states at the end of
+   * each event batch and render() draws items from the latest published copy, so events and rendering
+   * could run in different tasks (i.e. on different cores) without locking.
+   * @note items that render values via user callbacks (TextCallBack, ValuesList, DynamicScrollList labels)
+   * still read user data at render time, access to that data must be synchronized by the user
+   * @note pages and items must not be added or removed while render task is running
+   * 
+   * @param enable 
+   */
+  void setSnapshotMode(bool enable);
+
+  /**
+   * @brief publish render snapshot of current page
+   * it is called automatically after events in snapshot mode, must be called from the event task
+   * after changing menu state by other means, i.e. goPageId(), goItmId()
+   */
+  void publishSnapshot();
+
   // after calling render items
   //void setPostExec();
 
@@ -382,6 +831,33 @@ private:
 
   mui_err_t _any_focusable_item_on_a_page_e();
 
+  /**
+   * @brief focus item at specified position of current page's focus ring
+   * 
+   * @param ring_pos 
+   * @return mui_err_t 
+   */
+  mui_err_t _focus_ring_item(size_t ring_pos);
+
 };
 
 
+// ***********************************
+
+//    templates implementations
+
+// ***********************************
+template <class T, class... Args>
+T* MuiPlusPlus::makeItem(Args&&... args){
+  T* item = _arena.make<T>(std::forward<Args>(args)...);
+  if (!item) return nullptr;
+
+  // non-owning pointer, aliasing c-tor with an empty owner does not allocate control block and does not count references
+  if (addMuippItem(MuiItem_pt(MuiItem_pt(), item)) != mui_err_t::ok){
+    // id is invalid or already taken, destroy the item and give arena memory back
+    _arena.discard(item);
+    return nullptr;
+  }
+
+  return item;
+}
@@ -0,0 +1,214 @@
+#include "muipp_gfx.hpp"
+
+using namespace muipp;
+
+namespace {
+  // u8g2 font header
+  constexpr size_t font_header_size = 23;
+  enum font_hdr : uint8_t {
+    bits_per_0 = 2, bits_per_1, bits_per_char_width, bits_per_char_height, bits_per_char_x, bits_per_char_y, bits_per_delta_x,
+    max_char_height = 10, ascent_A = 13, descent_g = 14,
+    start_pos_upper_A = 17, start_pos_lower_a = 19, start_pos_unicode = 21
+  };
+
+  inline uint16_t get_word(const uint8_t* p){ return static_cast<uint16_t>(p[0] << 8 | p[1]); }
+
+  // reads bit fields of u8g2 glyph data, LSB first
+  struct bit_reader {
+    const uint8_t* p;
+    uint8_t pos{0};
+
+    unsigned u(uint8_t cnt){
+      unsigned val = *p >> pos;
+      unsigned next = pos + cnt;
+      if (next >= 8){
+        ++p;
+        val |= static_cast<unsigned>(*p) << (8 - pos);
+        next -= 8;
+      }
+      pos = next;
+      return val & ((1u << cnt) - 1);
+    }
+
+    int s(uint8_t cnt){ return static_cast<int>(u(cnt)) - (1 << (cnt - 1)); }
+  };
+
+  // decode next UTF-8 char (up to 3 bytes, u8g2 fonts are 16 bit) and advance pointer
+  uint16_t utf8_next(const char* &text){
+    const uint8_t c = static_cast<uint8_t>(*text++);
+    int tail = c >= 0xe0 ? 2 : c >= 0xc0 ? 1 : 0;
+    uint16_t e = tail == 2 ? c & 0x0f : tail == 1 ? c & 0x1f : c;
+    for (; tail && (static_cast<uint8_t>(*text) & 0xc0) == 0x80; --tail)
+      e = (e << 6) | (static_cast<uint8_t>(*text++) & 0x3f);
+    return e;
+  }
+}
+
+const uint8_t* FrameBuffer::_glyph(uint16_t encoding) const {
+  if (!_font) return nullptr;
+  const uint8_t* font = _font + font_header_size;
+
+  if (encoding <= 0xff){
+    // ASCII glyphs: encoding, jump offset to the next glyph, data
+    if (encoding >= 'a')
+      font += get_word(_font + start_pos_lower_a);
+    else if (encoding >= 'A')
+      font += get_word(_font + start_pos_upper_A);
+    for (; font[1]; font += font[1])
+      if (font[0] == encoding) return font + 2;
+    return nullptr;
+  }
+
+  // unicode glyphs: lookup table of (jump offset, last encoding in a block) pairs,
+  // then glyphs as 16 bit encoding, jump offset to the next glyph, data
+  font += get_word(_font + start_pos_unicode);
+  const uint8_t* table = font;
+  uint16_t e;
+  do {
+    font += get_word(table);
+    e = get_word(table + 2);
+    table += 4;
+  } while (e < encoding);
+
+  for (; (e = get_word(font)); font += font[2])
+    if (e == encoding) return font + 3;
+  return nullptr;
+}
+
+int FrameBuffer::_glyphWidth(uint16_t encoding, int &extent) const {
+  const uint8_t* g = _glyph(encoding);
+  extent = 0;
+  if (!g) return 0;
+  bit_reader r{g};
+  int w = r.u(_font[bits_per_char_width]);
+  r.u(_font[bits_per_char_height]);
+  int x = r.s(_font[bits_per_char_x]);
+  r.s(_font[bits_per_char_y]);
+  if (w) extent = w + x;
+  return r.s(_font[bits_per_delta_x]);
+}
+
+int FrameBuffer::_drawGlyph(int x, int y, uint16_t encoding){
+  const uint8_t* g = _glyph(encoding);
+  if (!g) return 0;
+  bit_reader r{g};
+  const int w = r.u(_font[bits_per_char_width]);
+  const int h = r.u(_font[bits_per_char_height]);
+  const int left = x + r.s(_font[bits_per_char_x]);
+  const int top = y - h - r.s(_font[bits_per_char_y]);
+  const int dx = r.s(_font[bits_per_delta_x]);
+  if (!w) return dx;
+
+  // run-length encoded bitmap: pairs of (background, foreground) pixel runs, a bit after each pair tells to repeat it
+  int px = 0, py = 0;
+  while (py < h){
+    const unsigned a = r.u(_font[bits_per_0]);
+    const unsigned b = r.u(_font[bits_per_1]);
+    do {
+      px += a;
+      py += px / w;
+      px %= w;
+      for (unsigned i = 0; i != b; ++i){
+        drawPixel(left + px, top + py);
+        if (++px == w){
+          px = 0;
+          ++py;
+        }
+      }
+    } while (r.u(1));
+  }
+  return dx;
+}
+
+int FrameBuffer::_vrefOffset() const {
+  switch (_vref){
+    case text_align_t::top : return getAscent();
+    case text_align_t::center : return (getAscent() - getDescent()) / 2 + getDescent();
+    case text_align_t::bottom : return getDescent();
+    default : return 0;
+  }
+}
+
+int FrameBuffer::drawUTF8(int x, int y, const char* text){
+  if (!_font || !text) return 0;
+  y += _vrefOffset();
+  int start = x;
+  while (*text)
+    x += _drawGlyph(x, y, utf8_next(text));
+  return x - start;
+}
+
+int FrameBuffer::getUTF8Width(const char* text) const {
+  if (!_font || !text) return 0;
+  int w = 0, dx = 0, extent = 0;
+  while (*text){
+    dx = _glyphWidth(utf8_next(text), extent);
+    w += dx;
+  }
+  // last glyph takes it's bitmap width, not advance
+  if (extent)
+    w += extent - dx;
+  return w;
+}
+
+void FrameBuffer::drawPixel(int x, int y){
+  if (x < 0 || y < 0 || x >= _w || y >= _h) return;
+  uint8_t &b = _buf[(y / 8) * _w + x];
+  const uint8_t mask = 1 << (y % 8);
+  switch (_color){
+    case 0 : b &= ~mask; break;
+    case 1 : b |= mask; break;
+    default : b ^= mask;
+  }
+}
+
+void FrameBuffer::drawFrame(int x, int y, int w, int h){
+  if (w <= 0 || h <= 0) return;
+  drawHLine(x, y, w);
+  if (h > 1)
+    drawHLine(x, y + h - 1, w);
+  // sides do not overlap corners, so xor mode draws a proper frame
+  if (h > 2){
+    drawVLine(x, y + 1, h - 2);
+    if (w > 1)
+      drawVLine(x + w - 1, y + 1, h - 2);
+  }
+}
+
+void FrameBuffer::drawButtonUTF8(int x, int y, uint8_t flags, int width, int padding_h, int padding_v, const char* text){
+  const int tw = getUTF8Width(text);
+  const int bw = tw < width ? width : tw;
+  if (flags & U8G2_BTN_HCENTER)
+    x -= bw / 2;
+  drawUTF8(x + (bw - tw) / 2, y, text);
+  drawButtonFrame(x, y, flags, bw, padding_h, padding_v);
+}
+
+void FrameBuffer::drawButtonFrame(int x, int y, uint8_t flags, int text_width, int padding_h, int padding_v){
+  // button area around text's baseline
+  const int bx = x - padding_h;
+  const int by = y + _vrefOffset() - getAscent() - padding_v;
+  const int bw = text_width + 2 * padding_h;
+  const int bh = getAscent() - getDescent() + 2 * padding_v;
+  const uint8_t color = _color;
+  if (flags & U8G2_BTN_INV){
+    _color = 2;
+    drawBox(bx, by, bw, bh);
+  }
+  // lower 3 bits is border width
+  _color = 1;
+  for (int i = 1; i <= (flags & 0x07); ++i)
+    drawFrame(bx - i, by - i, bw + 2 * i, bh + 2 * i);
+  _color = color;
+}
+
+int FrameBuffer::getAscent() const { return _font ? static_cast<int8_t>(_font[ascent_A]) : 0; }
+
+int FrameBuffer::getDescent() const { return _font ? static_cast<int8_t>(_font[descent_g]) : 0; }
+
+int FrameBuffer::getMaxCharHeight() const { return _font ? static_cast<int8_t>(_font[max_char_height]) : 0; }
+
+bool FrameBuffer::getPixel(int x, int y) const {
+  if (x < 0 || y < 0 || x >= _w || y >= _h) return false;
+  return _buf[(y / 8) * _w + x] & (1 << (y % 8));
+}
@@ -0,0 +1,324 @@
+#pragma once
+#include <algorithm>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "U8g2lib.h"
+#include "muipp_tpl.hpp"
+
+/*
+  Drawing backends
+
+  Drawing code that should not depend on display hardware is written as templates over a backend type,
+  so each primitive is resolved at compile time and no virtual calls are added to the render path.
+  A backend must provide following members (names and meaning match U8G2 class):
+
+    void setFont(const uint8_t* font)                         - set u8g2 font
+    void setFontPosBaseline(), setFontPosTop(),
+         setFontPosCenter(), setFontPosBottom()               - vertical text reference
+    void setDrawColor(uint8_t color)                          - 0 - clear, 1 - set, 2 - xor
+    int drawUTF8(x, y, const char* text)                      - returns text width
+    int getUTF8Width(const char* text)
+    void drawPixel(x, y), drawHLine(x, y, w), drawVLine(x, y, h)
+    void drawBox(x, y, w, h), drawFrame(x, y, w, h)
+    void drawButtonUTF8(x, y, flags, width, padding_h, padding_v, const char* text)
+    int getAscent(), getDescent(), getMaxCharHeight()
+    int getDisplayWidth(), getDisplayHeight()
+
+  and muipp::currentFont(), muipp::currentFontPos() and muipp::drawButtonFrame() overloads,
+  those are not members of U8G2 class. muipp::is_gfx_backend_v<T> checks a type for all of the above.
+
+  U8G2 itself is a backend for real displays, muipp::FrameBuffer is an in-memory 1-bpp backend
+  to run drawing code without display hardware, i.e. on a host.
+*/
+
+enum class text_align_t {
+  baseline = 0,
+  center,
+  top,
+  bottom,
+  left,
+  right
+};
+
+namespace muipp {
+
+// font that is currently set in u8g2 object
+inline const uint8_t* currentFont(U8G2 &u8g2){ return u8g2.getU8g2()->font; }
+
+// font vertical reference position that is currently set in u8g2 object
+inline text_align_t currentFontPos(U8G2 &u8g2){
+  // font position is defined by vref function set in u8g2 object
+  const u8g2_font_calc_vref_fnptr vref = u8g2.getU8g2()->font_calc_vref;
+  if (vref == u8g2_font_calc_vref_top) return text_align_t::top;
+  if (vref == u8g2_font_calc_vref_center) return text_align_t::center;
+  if (vref == u8g2_font_calc_vref_bottom) return text_align_t::bottom;
+  return text_align_t::baseline;
+}
+
+// draw button frame or inversion around a text of text_width printed at x,y, see u8g2 drawButtonUTF8()
+inline void drawButtonFrame(U8G2 &u8g2, int x, int y, uint8_t flags, int text_width, int padding_h, int padding_v){
+  u8g2_DrawButtonFrame(u8g2.getU8g2(), x, y, flags, text_width, padding_h, padding_v);
+}
+
+/**
+ * @brief in-memory 1-bpp frame buffer backend
+ * pixels are packed in vertical bytes in 8-pixel high tile rows, LSB at the top, same as u8g2 full buffer
+ * of SSD1306-like displays, so buffer contents could be compared or copied to u8g2 buffer as-is.
+ * Text is drawn with u8g2 fonts in transparent mode, i.e. glyph background is not drawn.
+ * drawButtonUTF8() supports frame width, U8G2_BTN_INV and U8G2_BTN_HCENTER flags
+ */
+class FrameBuffer {
+  int _w, _h;
+  std::vector<uint8_t> _buf;
+  uint8_t _color{1};
+  const uint8_t* _font{nullptr};
+  // text reference position
+  text_align_t _vref{text_align_t::baseline};
+
+  // find glyph data for unicode char, nullptr if font has no such glyph
+  const uint8_t* _glyph(uint16_t encoding) const;
+  // draw glyph with baseline at x,y, returns x advance
+  int _drawGlyph(int x, int y, uint16_t encoding);
+  // x advance of a glyph and it's bitmap width + x offset
+  int _glyphWidth(uint16_t encoding, int &extent) const;
+  int _vrefOffset() const;
+
+public:
+  /**
+   * @brief Construct a new Frame Buffer object
+   *
+   * @param width in pixels
+   * @param height in pixels, rounded up to multiple of 8 for the buffer
+   */
+  FrameBuffer(int width, int height) : _w(width), _h(height), _buf(width * ((height + 7) / 8)) {}
+
+  void setFont(const uint8_t* font){ _font = font; }
+  const uint8_t* getFont() const { return _font; }
+  void setFontPosBaseline(){ _vref = text_align_t::baseline; }
+  void setFontPosTop(){ _vref = text_align_t::top; }
+  void setFontPosCenter(){ _vref = text_align_t::center; }
+  void setFontPosBottom(){ _vref = text_align_t::bottom; }
+  text_align_t getFontPos() const { return _vref; }
+  void setDrawColor(uint8_t color){ _color = color; }
+
+  int drawUTF8(int x, int y, const char* text);
+  int getUTF8Width(const char* text) const;
+  void drawPixel(int x, int y);
+  void drawHLine(int x, int y, int w){ for (int i = 0; i < w; ++i) drawPixel(x + i, y); }
+  void drawVLine(int x, int y, int h){ for (int i = 0; i < h; ++i) drawPixel(x, y + i); }
+  void drawBox(int x, int y, int w, int h){ for (int i = 0; i < h; ++i) drawHLine(x, y + i, w); }
+  void drawFrame(int x, int y, int w, int h);
+  void drawButtonUTF8(int x, int y, uint8_t flags, int width, int padding_h, int padding_v, const char* text);
+  void drawButtonFrame(int x, int y, uint8_t flags, int text_width, int padding_h, int padding_v);
+
+  // font metrics, font height reference is text (A) and (g)
+  int getAscent() const;
+  int getDescent() const;
+  int getMaxCharHeight() const;
+  int getDisplayWidth() const { return _w; }
+  int getDisplayHeight() const { return _h; }
+
+  void clearBuffer(){ std::fill(_buf.begin(), _buf.end(), 0); }
+  uint8_t* getBufferPtr(){ return _buf.data(); }
+  size_t getBufferSize() const { return _buf.size(); }
+  bool getPixel(int x, int y) const;
+};
+
+inline const uint8_t* currentFont(FrameBuffer &fb){ return fb.getFont(); }
+
+inline text_align_t currentFontPos(FrameBuffer &fb){ return fb.getFontPos(); }
+
+inline void drawButtonFrame(FrameBuffer &fb, int x, int y, uint8_t flags, int text_width, int padding_h, int padding_v){
+  fb.drawButtonFrame(x, y, flags, text_width, padding_h, padding_v);
+}
+
+// checks that type provides all members and functions of a drawing backend listed above
+template <class T, class = void>
+struct is_gfx_backend : std::false_type {};
+
+template <class T>
+struct is_gfx_backend<T, std::void_t<
+    decltype(std::declval<T&>().setFont(std::declval<const uint8_t*>())),
+    decltype(std::declval<T&>().setFontPosBaseline()),
+    decltype(std::declval<T&>().setFontPosTop()),
+    decltype(std::declval<T&>().setFontPosCenter()),
+    decltype(std::declval<T&>().setFontPosBottom()),
+    decltype(std::declval<T&>().setDrawColor(uint8_t())),
+    decltype(std::declval<T&>().drawUTF8(0, 0, std::declval<const char*>()) + 0),
+    decltype(std::declval<T&>().getUTF8Width(std::declval<const char*>()) + 0),
+    decltype(std::declval<T&>().drawPixel(0, 0)),
+    decltype(std::declval<T&>().drawHLine(0, 0, 0)),
+    decltype(std::declval<T&>().drawVLine(0, 0, 0)),
+    decltype(std::declval<T&>().drawBox(0, 0, 0, 0)),
+    decltype(std::declval<T&>().drawFrame(0, 0, 0, 0)),
+    decltype(std::declval<T&>().drawButtonUTF8(0, 0, 0, 0, 0, 0, std::declval<const char*>())),
+    decltype(std::declval<T&>().getAscent() + 0),
+    decltype(std::declval<T&>().getDescent() + 0),
+    decltype(std::declval<T&>().getMaxCharHeight() + 0),
+    decltype(std::declval<T&>().getDisplayWidth() + 0),
+    decltype(std::declval<T&>().getDisplayHeight() + 0),
+    decltype(currentFont(std::declval<T&>()) == std::declval<const uint8_t*>()),
+    decltype(currentFontPos(std::declval<T&>()) == text_align_t::baseline),
+    decltype(drawButtonFrame(std::declval<T&>(), 0, 0, 0, 0, 0, 0))
+  >> : std::true_type {};
+
+template <class T>
+inline constexpr bool is_gfx_backend_v = is_gfx_backend<T>::value;
+
+static_assert(is_gfx_backend_v<U8G2>, "U8G2 must be a drawing backend");
+static_assert(is_gfx_backend_v<FrameBuffer>, "FrameBuffer must be a drawing backend");
+
+/**
+ * @brief word-wrapped text layout
+ * line breaks are computed once for a given text, font and width and kept as a copy of the text
+ * where each line is a separate null-terminated string, so every line is drawn with a single drawUTF8() call.
+ * Lines are broken on spaces, '\n' forces a new line, words longer than a line are broken on UTF-8 char boundary
+ */
+class TextLayout {
+  // text copy, lines are separated with '\0'
+  std::string _buf;
+  // offsets of line starts in _buf
+  std::vector<uint16_t> _lines;
+  // layout parameters it was computed for
+  const char* _text{nullptr};
+  uint32_t _hash{0};
+  const uint8_t* _font{nullptr};
+  int _x{0}, _width{0};
+
+  template <class Gfx>
+  void _layout(Gfx &gfx);
+
+public:
+  /**
+   * @brief recompute layout if text, font or geometry has changed since last call
+   * 
+   * @param gfx drawing backend, current font is used
+   * @param text text to layout
+   * @param x first line start position
+   * @param width right edge of the text area, next lines start from 0
+   */
+  template <class Gfx>
+  void update(Gfx &gfx, const char* text, int x, int width);
+
+  /**
+   * @brief draw text lines
+   * 
+   * @param gfx drawing backend
+   * @param y first line position
+   * @return int position of the last line
+   */
+  template <class Gfx>
+  int draw(Gfx &gfx, int y) const;
+
+  // number of lines
+  size_t size() const { return _lines.size(); }
+
+  // line text by index
+  const char* line(size_t i) const { return _buf.data() + _lines[i]; }
+};
+
+// ***********************************
+
+//    templates implementations
+
+// ***********************************
+template <class Gfx>
+void TextLayout::update(Gfx &gfx, const char* text, int x, int width){
+  const uint8_t* font = currentFont(gfx);
+  if (!text){
+    _text = nullptr;
+    _buf.clear();
+    _lines.clear();
+    return;
+  }
+  uint32_t hash = str_hash(text);
+  if (text == _text && hash == _hash && font == _font && x == _x && width == _width)
+    return;
+
+  _text = text;
+  _hash = hash;
+  _font = font;
+  _x = x;
+  _width = width;
+  _buf.assign(text);
+  _layout(gfx);
+}
+
+template <class Gfx>
+void TextLayout::_layout(Gfx &gfx){
+  _lines.clear();
+  size_t pos = 0;
+  int avail = _width - _x;
+
+  while (pos < _buf.size()){
+    // line fits up to this position (exclusive)
+    size_t fit = pos;
+    size_t i = pos;
+    bool newline = false;
+    for (;;){
+      // find end of the next word
+      size_t end = i;
+      while (end < _buf.size() && _buf[end] != ' ' && _buf[end] != '\n')
+        ++end;
+
+      // measure line up to the end of the word
+      char c = _buf[end];
+      _buf[end] = 0;
+      bool fits = gfx.getUTF8Width(_buf.data() + pos) <= avail;
+      _buf[end] = c;
+
+      if (!fits) break;
+      fit = end;
+      if (end == _buf.size()) break;
+      if (c == '\n'){
+        newline = true;
+        break;
+      }
+      i = end + 1;
+    }
+
+    if (fit == pos && !newline && pos < _buf.size()){
+      // a word does not fit into a line at all, break it on UTF-8 char boundary, but take at least one char
+      size_t end = pos;
+      do {
+        size_t next = end + 1;
+        while (next < _buf.size() && (static_cast<uint8_t>(_buf[next]) & 0xc0) == 0x80) ++next;
+        char c = _buf[next];
+        _buf[next] = 0;
+        bool fits = gfx.getUTF8Width(_buf.data() + pos) <= avail;
+        _buf[next] = c;
+        if (!fits && end != pos) break;
+        end = next;
+      } while (end < _buf.size() && _buf[end] != ' ' && _buf[end] != '\n');
+      fit = end;
+      // no separator to replace with line terminator, make room for it
+      if (fit < _buf.size() && _buf[fit] != ' ' && _buf[fit] != '\n')
+        _buf.insert(fit, 1, ' ');
+    }
+
+    _lines.push_back(pos);
+    if (fit >= _buf.size()) break;
+
+    // line is terminated in place of the separator
+    newline = _buf[fit] == '\n';
+    _buf[fit] = 0;
+    pos = fit + 1;
+    // wrapped lines do not start with blanks
+    if (!newline)
+      while (pos < _buf.size() && _buf[pos] == ' ') ++pos;
+    avail = _width;
+  }
+}
+
+template <class Gfx>
+int TextLayout::draw(Gfx &gfx, int y) const {
+  int h = gfx.getMaxCharHeight();
+  for (size_t i = 0; i != _lines.size(); ++i){
+    if (i) y += h;
+    gfx.drawUTF8(i ? 0 : _x, y, line(i));
+  }
+  return y;
+}
+
+} // end of namespace muipp
@@ -0,0 +1,105 @@
+#include "muipp_scheduler.hpp"
+
+using namespace muipp;
+
+RenderScheduler::RenderScheduler(MuiPlusPlus &menu, render_cb_t render, unsigned max_fps, reply_cb_t reply)
+  : _menu(menu), _render(render), _reply(reply), _input(clock_type::now()) {
+  setMaxFps(max_fps);
+}
+
+bool RenderScheduler::postEvent(mui_event e){
+  if (!_menu.postEvent(e))
+    return false;
+  _wake();
+  return true;
+}
+
+void RenderScheduler::notify(){
+  _wake();
+}
+
+void RenderScheduler::_wake(){
+  {
+    std::lock_guard<std::mutex> lock(_mtx);
+    if (_pending){
+      // frame is already requested, this notification will be handled with it
+      ++_stats.skipped;
+      return;
+    }
+    _pending = true;
+    _input = clock_type::now();
+  }
+  _cv.notify_one();
+}
+
+void RenderScheduler::run(){
+  std::unique_lock<std::mutex> lock(_mtx);
+  // earliest time when next frame could be drawn
+  clock_type::time_point next = clock_type::now();
+
+  while (!_stop){
+    // sleep until something happens
+    _cv.wait(lock, [this]{ return _pending || _stop; });
+    if (_stop) break;
+
+    // keep frame rate limit, notifications arriving meanwhile are merged into this frame
+    if (_cv.wait_until(lock, next, [this]{ return _stop; }))
+      break;
+
+    _pending = false;
+    const clock_type::time_point input = _input;
+    lock.unlock();
+
+    // processEvents() stops on a reply event, pass it to the user and go on until the queue is empty
+    for (mui_event r = _menu.processEvents(); r.eid != mui_event_t::noop; r = _menu.processEvents())
+      if (_reply) _reply(r);
+    const clock_type::time_point start = clock_type::now();
+    const bool redraw = _menu.needsRedraw();
+    if (redraw && _render)
+      _render();
+    const clock_type::time_point done = clock_type::now();
+
+    lock.lock();
+    if (redraw){
+      ++_stats.rendered;
+      uint32_t latency = std::chrono::duration_cast<std::chrono::microseconds>(done - input).count();
+      _stats.latency_last = latency;
+      if (latency > _stats.latency_max)
+        _stats.latency_max = latency;
+      _stats.latency_total += latency;
+      next = start + _interval;
+    } else
+      ++_stats.skipped;
+
+    // events posted to the menu directly while rendering, handle those with the next frame
+    if (!_pending && _menu.eventsPending()){
+      _pending = true;
+      _input = clock_type::now();
+    }
+  }
+  // scheduler could be restarted
+  _stop = false;
+}
+
+void RenderScheduler::stop(){
+  {
+    std::lock_guard<std::mutex> lock(_mtx);
+    _stop = true;
+  }
+  _cv.notify_one();
+}
+
+void RenderScheduler::setMaxFps(unsigned max_fps){
+  std::lock_guard<std::mutex> lock(_mtx);
+  _interval = max_fps ? std::chrono::duration_cast<clock_type::duration>(std::chrono::seconds(1)) / max_fps : clock_type::duration::zero();
+}
+
+render_stats_t RenderScheduler::stats(){
+  std::lock_guard<std::mutex> lock(_mtx);
+  return _stats;
+}
+
+void RenderScheduler::resetStats(){
+  std::lock_guard<std::mutex> lock(_mtx);
+  _stats = render_stats_t();
+}
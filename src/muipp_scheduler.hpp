@@ -0,0 +1,119 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include "muiplusplus.hpp"
+
+/*
+  On-change render scheduler
+
+  Instead of polling menu and redrawing display at fixed intervals, render task blocks in RenderScheduler::run()
+  until some other task posts an event or notifies about a data change. Events that arrive while a frame
+  is pending or frame rate limit has not expired yet are merged into a single frame. While nothing happens
+  render task sleeps indefinitely.
+
+  // input task
+  scheduler.postEvent(mui_event(mui_event_t::moveDown));
+
+  // render task
+  scheduler.run();
+*/
+
+namespace muipp {
+
+// render scheduler counters
+struct render_stats_t {
+  // frames drawn with render callback
+  uint32_t rendered;
+  // notifications that did not produce a frame of their own, i.e. were merged into a pending frame or changed nothing
+  uint32_t skipped;
+  // time from the first input of a frame to the end of frame rendering, microseconds
+  uint32_t latency_last;
+  uint32_t latency_max;
+  // sum of latencies of all rendered frames, divide by 'rendered' to get an average
+  uint64_t latency_total;
+};
+
+class RenderScheduler {
+public:
+  // render callback, should draw the menu and send it to display
+  using render_cb_t = muipp::delegate<void (void)>;
+  // callback that receives non-noop events menu replied with, i.e. mui_event_t::quitMenu
+  using reply_cb_t = muipp::delegate<void (mui_event e)>;
+
+  /**
+   * @brief Construct a new Render Scheduler object
+   *
+   * @param menu menu object, it's queued events are processed in render task
+   * @param render callback that draws a frame, i.e. calls menu.render() and u8g2.sendBuffer()
+   * @param max_fps frame rate limit, 0 - unlimited
+   * @param reply callback for menu reply events, it is called from render task
+   */
+  RenderScheduler(MuiPlusPlus &menu, render_cb_t render, unsigned max_fps = 30, reply_cb_t reply = nullptr);
+
+  /**
+   * @brief post event to menu's queue and wake render task
+   * events are processed in render task with MuiPlusPlus::processEvents() before drawing the frame
+   * @note it locks a mutex, so it can't be called from an ISR, there must be only one producer task posting events
+   *
+   * @param e input event struct
+   * @return true if event was queued
+   * @return false if queue is full
+   */
+  bool postEvent(mui_event e);
+
+  /**
+   * @brief wake render task to check if menu needs redraw
+   * menu is processed and rendered in render task, so input from other tasks must always go through postEvent(),
+   * calling muiEvent() or changing items from other tasks is a data race.
+   * notify() is only for changes made on render task itself, i.e. an item was invalidated from reply callback
+   */
+  void notify();
+
+  /**
+   * @brief render loop
+   * blocks calling task until stop() is called, draws a frame on each notification if menu needs redraw,
+   * but not more often than max_fps frames per second. All queued events are processed before each frame,
+   * events menu replies with are passed to reply callback
+   */
+  void run();
+
+  // make run() return, could be called from any task
+  void stop();
+
+  /**
+   * @brief set frame rate limit
+   *
+   * @param max_fps frames per second, 0 - unlimited
+   */
+  void setMaxFps(unsigned max_fps);
+
+  // get a copy of scheduler counters
+  render_stats_t stats();
+
+  // reset scheduler counters
+  void resetStats();
+
+private:
+  using clock_type = std::chrono::steady_clock;
+
+  MuiPlusPlus &_menu;
+  render_cb_t _render;
+  reply_cb_t _reply;
+
+  std::mutex _mtx;
+  std::condition_variable _cv;
+  // frame is requested, first frame is always drawn
+  bool _pending{true};
+  bool _stop{false};
+  // min interval between frames
+  clock_type::duration _interval;
+  // time of the earliest notification of a pending frame
+  clock_type::time_point _input;
+  render_stats_t _stats{};
+
+  // mark frame pending and wake render task
+  void _wake();
+};
+
+} // end of namespace muipp
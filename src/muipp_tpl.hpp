@@ -1,8 +1,40 @@
 #pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <new>
 #include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 using muiItemId = uint32_t;
 
+// ids starting from this value are reserved for user and never auto-assigned by MuiPlusPlus::nextIndex()
+#ifndef MUIPP_USER_ID_BASE
+#define MUIPP_USER_ID_BASE  0x10000
+#endif
+
+// inline storage size for callables kept in muipp::delegate, enough for a lambda capturing a few pointers/refs
+#ifndef MUIPP_DELEGATE_SIZE
+#define MUIPP_DELEGATE_SIZE  (3 * sizeof(void*))
+#endif
+
+// size of MuiPlusPlus posted events queue, must be power of 2
+#ifndef MUIPP_EVENT_QUEUE_SIZE
+#define MUIPP_EVENT_QUEUE_SIZE  16
+#endif
+
+// max number of pending reply events during single event dispatch, must be a power of 2
+#ifndef MUIPP_REPLY_QUEUE_SIZE
+#define MUIPP_REPLY_QUEUE_SIZE  8
+#endif
+
+// default size of memory blocks allocated by item arena
+#ifndef MUIPP_ARENA_BLOCK_SIZE
+#define MUIPP_ARENA_BLOCK_SIZE  1024
+#endif
+
 namespace muipp {
 
 // Unary predicate for Mui's label search matching
@@ -41,12 +73,418 @@ public:
   }
 };
 
+/**
+ * @brief id allocator for auto-assigned item ids
+ * keeps a bitmap of taken ids in auto range [1, MUIPP_USER_ID_BASE) and a free-list of released ids,
+ * so that next available id is returned in amortized constant time.
+ * Ids at or above MUIPP_USER_ID_BASE are reserved for the user and never returned by next()
+ */
+class IdAllocator {
+  // bitmap of taken ids in auto range
+  std::vector<uint32_t> _used;
+  // released ids that could be reused
+  std::vector<muiItemId> _free;
+  // highest id ever returned by next()
+  muiItemId _top{0};
+
+  void _set(muiItemId id){ if (id / 32 >= _used.size()) _used.resize(id / 32 + 1); _used[id / 32] |= 1UL << (id % 32); }
+
+public:
+  // check if id is taken
+  bool used(muiItemId id) const { return id / 32 < _used.size() && (_used[id / 32] & (1UL << (id % 32))); }
+
+  /**
+   * @brief get next available id and mark it as taken
+   * 
+   * @return muiItemId, 0 if auto range is exhausted
+   */
+  muiItemId next(){
+    // reuse released ids first
+    while (_free.size()){
+      muiItemId id = _free.back();
+      _free.pop_back();
+      // id could have been taken by user item meanwhile
+      if (used(id)) continue;
+      _set(id);
+      return id;
+    }
+    // each id in range is skipped at most once, so it's amortized O(1)
+    while (++_top < MUIPP_USER_ID_BASE){
+      if (!used(_top)){
+        _set(_top);
+        return _top;
+      }
+    }
+    _top = MUIPP_USER_ID_BASE;
+    return 0;
+  }
+
+  // mark user-provided id as taken, ids from user range are not tracked
+  void take(muiItemId id){ if (id && id < MUIPP_USER_ID_BASE) _set(id); }
+
+  // release id, so it could be reused by next()
+  void release(muiItemId id){
+    if (!used(id)) return;
+    _used[id / 32] &= ~(1UL << (id % 32));
+    // ids above top will be found by next() anyway
+    if (id <= _top) _free.push_back(id);
+  }
+};
+
+/**
+ * @brief monotonic arena for objects with common life-time
+ * objects are placed into large memory blocks and are destroyed all at once (in reverse order of creation)
+ * on arena destruction or release() call. Individual objects could not be freed.
+ * It saves per-object heap allocations and does not fragment heap when lots of small objects are created/destroyed
+ */
+class Arena {
+  // memory block header, data follows the header
+  struct block_t {
+    block_t* next;
+    size_t size;
+    size_t used;
+  };
+  // destructor record, placed in arena memory along with the object
+  struct dtor_t {
+    void (*dtor)(void*);
+    void* obj;
+    dtor_t* next;
+  };
+
+  block_t* _blocks{nullptr};
+  dtor_t* _dtors{nullptr};
+
+  void* _alloc(size_t size, size_t align){
+    if (_blocks){
+      uintptr_t base = reinterpret_cast<uintptr_t>(_blocks + 1);
+      uintptr_t p = (base + _blocks->used + align - 1) & ~(static_cast<uintptr_t>(align) - 1);
+      if (p + size <= base + _blocks->size){
+        _blocks->used = p + size - base;
+        return reinterpret_cast<void*>(p);
+      }
+    }
+    // allocate new block, oversized objects get their own block
+    size_t bsize = size + align > MUIPP_ARENA_BLOCK_SIZE ? size + align : MUIPP_ARENA_BLOCK_SIZE;
+    void* mem = ::operator new(sizeof(block_t) + bsize, std::nothrow);
+    if (!mem) return nullptr;
+    _blocks = new (mem) block_t{_blocks, bsize, 0};
+    return _alloc(size, align);
+  }
+
+public:
+  Arena() = default;
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+  ~Arena(){ release(); }
+
+  /**
+   * @brief construct object of type T in arena memory
+   * 
+   * @return T* pointer to the object or nullptr if memory allocation failed
+   */
+  template <class T, class... Args>
+  T* make(Args&&... args){
+    dtor_t* rec{nullptr};
+    if constexpr (!std::is_trivially_destructible_v<T>){
+      rec = static_cast<dtor_t*>(_alloc(sizeof(dtor_t), alignof(dtor_t)));
+      if (!rec) return nullptr;
+    }
+    void* mem = _alloc(sizeof(T), alignof(T));
+    if (!mem) return nullptr;
+    T* obj = new (mem) T(std::forward<Args>(args)...);
+    if (rec)
+      _dtors = new (rec) dtor_t{ [](void* p){ static_cast<T*>(p)->~T(); }, obj, _dtors };
+    return obj;
+  }
+
+  /**
+   * @brief destroy an object that was the last one made in arena and give it's memory back
+   * objects made earlier are not affected
+   * 
+   * @param obj pointer returned by the last make() call
+   */
+  template <class T>
+  void discard(T* obj){
+    uintptr_t start = reinterpret_cast<uintptr_t>(obj);
+    if constexpr (!std::is_trivially_destructible_v<T>){
+      // destructor record was allocated right before the object
+      if (_dtors && _dtors->obj == obj){
+        start = reinterpret_cast<uintptr_t>(_dtors);
+        _dtors = _dtors->next;
+      }
+    }
+    obj->~T();
+    // rewind current block if object is at it's end
+    uintptr_t base = reinterpret_cast<uintptr_t>(_blocks + 1);
+    uintptr_t obj_at = reinterpret_cast<uintptr_t>(obj);
+    if (obj_at < base || obj_at + sizeof(T) != base + _blocks->used) return;
+    // destructor record could be left in previous block
+    if (start < base) start = obj_at;
+    _blocks->used = start - base;
+  }
+
+  /**
+   * @brief destroy all objects and free arena memory
+   */
+  void release(){
+    while (_dtors){
+      dtor_t* d = _dtors;
+      _dtors = d->next;
+      d->dtor(d->obj);
+    }
+    while (_blocks){
+      block_t* b = _blocks;
+      _blocks = b->next;
+      ::operator delete(b);
+    }
+  }
+};
+
+template <class Sig, size_t Size = MUIPP_DELEGATE_SIZE>
+class delegate;
+
+/**
+ * @brief non-allocating callable wrapper, a replacement for std::function
+ * callable object (lambda, functor, function pointer) is kept in a fixed inline storage,
+ * callables that does not fit into storage are rejected at compile time
+ * 
+ * @tparam R return type
+ * @tparam Args arguments types
+ * @tparam Size inline storage size
+ */
+template <class R, class... Args, size_t Size>
+class delegate<R(Args...), Size> {
+  using invoke_t = R (*)(void*, Args&&...);
+  enum class op_t { copy, move, destroy };
+  // copies or moves object from src to dst, or destroys dst
+  using manage_t = void (*)(op_t op, void* dst, void* src);
+
+  // storage is zeroed, so that trivially copyable callables could be copied as a whole block
+  alignas(alignof(std::max_align_t)) unsigned char _buf[Size]{};
+  invoke_t _invoke{nullptr};
+  // null for trivially copyable callables
+  manage_t _manage{nullptr};
+
+  void _take(const delegate& other, op_t op){
+    if (other._manage)
+      other._manage(op, _buf, const_cast<unsigned char*>(other._buf));
+    else if (other._invoke)
+      std::memcpy(_buf, other._buf, Size);
+    _invoke = other._invoke;
+    _manage = other._manage;
+  }
+
+public:
+  delegate() = default;
+  delegate(std::nullptr_t){}
+
+  template <class F, class = std::enable_if_t< !std::is_same_v<std::decay_t<F>, delegate> && std::is_invocable_r_v<R, std::decay_t<F>&, Args...> > >
+  delegate(F&& f){
+    using Fn = std::decay_t<F>;
+    static_assert(sizeof(Fn) <= Size, "callable does not fit into delegate's inline storage (std::function objects and large captures are not supported), capture less or increase MUIPP_DELEGATE_SIZE");
+    static_assert(alignof(Fn) <= alignof(std::max_align_t), "callable alignment is not supported");
+    new (_buf) Fn(std::forward<F>(f));
+    _invoke = [](void* obj, Args&&... args) -> R { return (*static_cast<Fn*>(obj))(std::forward<Args>(args)...); };
+    if constexpr (!std::is_trivially_copyable_v<Fn>)
+      _manage = [](op_t op, void* dst, void* src){
+        switch (op){
+          case op_t::copy : new (dst) Fn(*static_cast<const Fn*>(src)); break;
+          case op_t::move : new (dst) Fn(std::move(*static_cast<Fn*>(src))); break;
+          default : static_cast<Fn*>(dst)->~Fn();
+        }
+      };
+  }
+
+  delegate(const delegate& other){ _take(other, op_t::copy); }
+
+  delegate(delegate&& other){
+    _take(other, op_t::move);
+    other.reset();
+  }
+
+  delegate& operator=(const delegate& other){
+    if (this != &other){
+      reset();
+      _take(other, op_t::copy);
+    }
+    return *this;
+  }
+
+  delegate& operator=(delegate&& other){
+    if (this != &other){
+      reset();
+      _take(other, op_t::move);
+      other.reset();
+    }
+    return *this;
+  }
+
+  delegate& operator=(std::nullptr_t){ reset(); return *this; }
+
+  ~delegate(){ reset(); }
+
+  // release callable
+  void reset(){
+    if (_manage) _manage(op_t::destroy, _buf, nullptr);
+    _invoke = nullptr;
+    _manage = nullptr;
+  }
+
+  explicit operator bool() const { return _invoke != nullptr; }
+
+  R operator()(Args... args) const { return _invoke(const_cast<unsigned char*>(_buf), std::forward<Args>(args)...); }
+};
+
+/**
+ * @brief bounded lock-free single-producer/single-consumer queue
+ * push() and pop() could be called concurrently from two different tasks (or ISR and a task)
+ * as long as there is only one producer and one consumer
+ * 
+ * @tparam T element type
+ * @tparam N queue size, must be power of 2
+ */
+template <class T, size_t N>
+class spsc_queue {
+  static_assert(N && !(N & (N - 1)), "queue size must be power of 2");
+  T _buf[N];
+  // read position, written by consumer only
+  std::atomic<size_t> _head{0};
+  // write position, written by producer only
+  std::atomic<size_t> _tail{0};
+
+public:
+  /**
+   * @brief add element to the queue (producer side)
+   * 
+   * @return true on success
+   * @return false if queue is full
+   */
+  bool push(const T& v){
+    size_t t = _tail.load(std::memory_order_relaxed);
+    if (t - _head.load(std::memory_order_acquire) == N) return false;
+    _buf[t & (N - 1)] = v;
+    _tail.store(t + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief take element from the queue (consumer side)
+   * 
+   * @return true on success
+   * @return false if queue is empty
+   */
+  bool pop(T& v){
+    size_t h = _head.load(std::memory_order_relaxed);
+    if (h == _tail.load(std::memory_order_acquire)) return false;
+    v = _buf[h & (N - 1)];
+    _head.store(h + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief access element at the front of the queue without removing it (consumer side)
+   * 
+   * @return const T* pointer to element or nullptr if queue is empty
+   */
+  const T* peek() const {
+    size_t h = _head.load(std::memory_order_relaxed);
+    if (h == _tail.load(std::memory_order_acquire)) return nullptr;
+    return &_buf[h & (N - 1)];
+  }
+
+  bool empty() const { return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire); }
+};
+
+/**
+ * @brief lock-free triple buffer for a single writer and a single reader task
+ * writer fills back() slot and publishes it, reader always gets the latest published slot with front(),
+ * neither side ever waits for the other and slots are never accessed by both tasks at the same time
+ * 
+ * @tparam T slot type
+ */
+template <class T>
+class triple_buffer {
+  static constexpr uint8_t fresh = 4;
+  T _buf[3];
+  // slot exchanged between writer and reader, 'fresh' bit is set when it holds unread data
+  std::atomic<uint8_t> _middle{1};
+  // slot owned by writer
+  uint8_t _back{0};
+  // slot owned by reader
+  uint8_t _front{2};
+
+public:
+  // slot to be filled by the writer
+  T& back(){ return _buf[_back]; }
+
+  // publish back slot to the reader (writer side)
+  void publish(){ _back = _middle.exchange(_back | fresh, std::memory_order_acq_rel) & (fresh - 1); }
+
+  // latest published slot (reader side), it stays valid until the next front() call
+  const T& front(){
+    if (_middle.load(std::memory_order_relaxed) & fresh)
+      _front = _middle.exchange(_front, std::memory_order_acq_rel) & (fresh - 1);
+    return _buf[_front];
+  }
+
+  // slot returned by last front() call (reader side)
+  const T& current() const { return _buf[_front]; }
+};
+
+/**
+ * @brief vector-like container that could either own it's elements or reference an external constant array
+ * (i.e. placed in flash), in the latter case no memory is allocated until container is modified,
+ * then elements are copied to own storage (copy-on-write)
+ * 
+ * @tparam T element type
+ */
+template <class T>
+class cow_vector {
+  std::vector<T> _v;
+  // elements view, points either to own storage or to external array
+  const T* _data{nullptr};
+  size_t _size{0};
+
+  // copy external array to own storage
+  void _own(){
+    if (_data == _v.data()) return;
+    _v.assign(_data, _data + _size);
+    _data = _v.data();
+  }
+
+public:
+  cow_vector() = default;
+  // containter must not be copied, it's view could point to own storage
+  cow_vector(const cow_vector&) = delete;
+  cow_vector& operator=(const cow_vector&) = delete;
+
+  // reference external array, array MUST persist while container exist
+  void assign_static(const T* data, size_t size){ _v.clear(); _data = data; _size = size; }
+
+  size_t size() const { return _size; }
+  const T* begin() const { return _data; }
+  const T* end() const { return _data + _size; }
+  const T& operator[](size_t pos) const { return _data[pos]; }
+
+  void emplace_back(const T& v){ _own(); _v.emplace_back(v); _data = _v.data(); _size = _v.size(); }
+
+  void erase(size_t pos){ _own(); _v.erase(_v.begin() + pos); _data = _v.data(); _size = _v.size(); }
+};
+
 // a simple constrain function
 template<typename T>
 T clamp(T value, T min, T max){
   return (value < min)? min : (value > max)? max : value;
 }
 
+// FNV-1a hash of the string, it is much cheaper than walking font glyphs for each char
+inline uint32_t str_hash(const char* text){
+  uint32_t hash = 2166136261u;
+  for (const char* c = text; *c; ++c)
+    hash = (hash ^ static_cast<uint8_t>(*c)) * 16777619u;
+  return hash;
+}
+
 
 
 
@@ -0,0 +1,97 @@
+#include "muipp_trace.hpp"
+
+#if MUIPP_TRACE_LEVEL > MUIPP_TRACE_NONE
+
+static_assert((MUIPP_TRACE_BUFFER_SIZE & (MUIPP_TRACE_BUFFER_SIZE - 1)) == 0, "MUIPP_TRACE_BUFFER_SIZE must be power of 2");
+
+namespace muipp {
+namespace trace {
+
+// ring buffer slot, fields are atomic words, so that slots could be read while other tasks write to it
+struct trace_slot_t {
+  // (record number + 1) when record is complete, 0 while it is being written
+  std::atomic<uint32_t> seq;
+  std::atomic<uint32_t> ts;
+  std::atomic<uint32_t> item;
+  // trace point in high half, argument in low half
+  std::atomic<uint32_t> info;
+};
+
+static trace_slot_t _buff[MUIPP_TRACE_BUFFER_SIZE];
+// total number of records written
+static std::atomic<uint32_t> _head{0};
+
+// load record number i if it is complete and was not overwritten meanwhile
+static bool _load(uint32_t i, trace_record_t &r){
+  trace_slot_t &s = _buff[i & (MUIPP_TRACE_BUFFER_SIZE - 1)];
+  const uint32_t seq = s.seq.load(std::memory_order_acquire);
+  if (seq != i + 1) return false;
+  // acquire loads keep sequence re-check after the fields, so a field from a newer write is always detected
+  r.ts = s.ts.load(std::memory_order_acquire);
+  r.item = s.item.load(std::memory_order_acquire);
+  uint32_t info = s.info.load(std::memory_order_acquire);
+  r.point = static_cast<trace_point_t>(info >> 16);
+  r.arg = static_cast<uint16_t>(info);
+  return s.seq.load(std::memory_order_relaxed) == seq;
+}
+
+static const char* const _names[] = {
+  "none", "item_dtor", "item_add", "item_exist", "item_noid", "item_notfound", "item_bind", "page_make", "page_notfound",
+  "page_autoselect", "page_go", "menu_event", "menu_navigation", "menu_evt_drop", "item_next", "item_prev",
+  "item_none", "list_render", "list_row", "list_event"
+};
+static_assert(sizeof(_names)/sizeof(_names[0]) == static_cast<size_t>(trace_point_t::count), "trace point names do not match trace_point_t");
+
+void record(trace_point_t point, muiItemId item, uint32_t arg){
+  uint32_t idx = _head.fetch_add(1, std::memory_order_relaxed);
+  trace_slot_t &s = _buff[idx & (MUIPP_TRACE_BUFFER_SIZE - 1)];
+  // mark slot incomplete before touching the fields, release stores keep the mark ahead of each field
+  s.seq.store(0, std::memory_order_relaxed);
+  s.ts.store(static_cast<uint32_t>(micros()), std::memory_order_release);
+  s.item.store(item, std::memory_order_release);
+  s.info.store(static_cast<uint32_t>(point) << 16 | static_cast<uint16_t>(arg), std::memory_order_release);
+  s.seq.store(idx + 1, std::memory_order_release);
+}
+
+size_t read(trace_record_t* dst, size_t max){
+  uint32_t head = _head.load(std::memory_order_acquire);
+  uint32_t cnt = head < MUIPP_TRACE_BUFFER_SIZE ? head : MUIPP_TRACE_BUFFER_SIZE;
+  if (cnt > max) cnt = max;
+  size_t n = 0;
+  for (uint32_t i = head - cnt; i != head; ++i)
+    if (_load(i, dst[n])) ++n;
+  return n;
+}
+
+void dump(Print &out){
+  uint32_t head = _head.load(std::memory_order_acquire);
+  uint32_t cnt = head < MUIPP_TRACE_BUFFER_SIZE ? head : MUIPP_TRACE_BUFFER_SIZE;
+  trace_record_t r;
+  for (uint32_t i = head - cnt; i != head; ++i){
+    if (!_load(i, r)) continue;
+    size_t p = static_cast<size_t>(r.point);
+    out.printf("%10u %-16s item:%u arg:%u\n", r.ts, p < sizeof(_names)/sizeof(_names[0]) ? _names[p] : "?", r.item, r.arg);
+  }
+}
+
+void clear(){
+  _head.store(0, std::memory_order_relaxed);
+  for (auto &s : _buff)
+    s.seq.store(0, std::memory_order_relaxed);
+}
+
+} // namespace trace
+} // namespace muipp
+
+#else   // tracing disabled
+
+namespace muipp {
+namespace trace {
+void record(trace_point_t point, muiItemId item, uint32_t arg){}
+size_t read(trace_record_t* dst, size_t max){ return 0; }
+void dump(Print &out){}
+void clear(){}
+} // namespace trace
+} // namespace muipp
+
+#endif
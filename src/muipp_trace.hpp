@@ -0,0 +1,118 @@
+#pragma once
+#include <atomic>
+#include "muipp_tpl.hpp"
+#include "Arduino.h"
+
+/*
+  Compile-time tracing for MuiPlusPlus internals
+
+  Trace points are compiled out completely unless MUIPP_TRACE_LEVEL is defined to a non-zero level via build flags,
+  i.e. -DMUIPP_TRACE_LEVEL=3
+  When enabled, each trace point writes a compact binary record (timestamp, trace point id, item id, argument)
+  into a ring buffer, no formatting is done on the hot path. Records could be dumped later with muipp::trace::dump()
+*/
+
+// trace levels
+#define MUIPP_TRACE_NONE      0
+#define MUIPP_TRACE_ERROR     1   // errors, i.e. ids not found, etc...
+#define MUIPP_TRACE_INFO      2   // menu structure changes, creating pages/items, etc...
+#define MUIPP_TRACE_DEBUG     3   // events and navigation
+#define MUIPP_TRACE_VERBOSE   4   // per-frame rendering
+
+#ifndef MUIPP_TRACE_LEVEL
+#define MUIPP_TRACE_LEVEL MUIPP_TRACE_NONE
+#endif
+
+// number of records in a trace ring buffer, must be power of 2
+#ifndef MUIPP_TRACE_BUFFER_SIZE
+#define MUIPP_TRACE_BUFFER_SIZE 64
+#endif
+
+namespace muipp {
+
+// trace point identifiers
+enum class trace_point_t : uint16_t {
+  none = 0,
+  item_dtor,          // item destroyed
+  item_add,           // item added to container, arg - page id
+  item_exist,         // item with same id already exist
+  item_noid,          // item with id 0 rejected
+  item_notfound,      // item id not found
+  item_bind,          // item bound to page, arg - page id
+  page_make,          // page created, arg - parent page id
+  page_notfound,      // page id not found
+  page_autoselect,    // page autoselect item set, item - page id, arg - item id
+  page_go,            // switching to page, item - page id, arg - item id
+  menu_event,         // MuiPlusPlus received event, arg - event id
+  menu_navigation,    // navigation event handling, arg - event id
+  menu_evt_drop,      // reply event dropped due to full queue or exhausted budget, arg - event id
+  item_next,          // focus next item
+  item_prev,          // focus previous item
+  item_none,          // no focusable items on a page, item - page id
+  list_render,        // DynamicScrollList rendered, arg - list size
+  list_row,           // DynamicScrollList row rendered, arg - row index
+  list_event,         // DynamicScrollList received event, arg - event id
+  count               // number of trace points, must be the last one
+};
+
+// trace record
+struct trace_record_t {
+  // timestamp, us
+  uint32_t ts;
+  muiItemId item;
+  trace_point_t point;
+  uint16_t arg;
+};
+
+namespace trace {
+
+/**
+ * @brief write trace record to a ring buffer
+ * it could be called from different tasks, records are committed with a per-slot sequence number,
+ * read() and dump() skip records that are being written or were overwritten while read.
+ * A record could be lost if the whole ring buffer wraps around while it is being written
+ */
+void record(trace_point_t point, muiItemId item = 0, uint32_t arg = 0);
+
+/**
+ * @brief copy trace records from ring buffer, oldest first
+ * could be called while other tasks are recording, incomplete records are skipped
+ * 
+ * @param dst destination array
+ * @param max size of destination array
+ * @return size_t number of records copied
+ */
+size_t read(trace_record_t* dst, size_t max);
+
+// print trace records in human readable form, oldest first
+void dump(Print &out);
+
+// clear ring buffer, must not be called while other tasks are recording
+void clear();
+
+} // namespace trace
+} // namespace muipp
+
+#if MUIPP_TRACE_LEVEL >= MUIPP_TRACE_ERROR
+#define MUIPP_TRACE_E(point, ...) muipp::trace::record(muipp::trace_point_t::point, ##__VA_ARGS__)
+#else
+#define MUIPP_TRACE_E(point, ...)
+#endif
+
+#if MUIPP_TRACE_LEVEL >= MUIPP_TRACE_INFO
+#define MUIPP_TRACE_I(point, ...) muipp::trace::record(muipp::trace_point_t::point, ##__VA_ARGS__)
+#else
+#define MUIPP_TRACE_I(point, ...)
+#endif
+
+#if MUIPP_TRACE_LEVEL >= MUIPP_TRACE_DEBUG
+#define MUIPP_TRACE_D(point, ...) muipp::trace::record(muipp::trace_point_t::point, ##__VA_ARGS__)
+#else
+#define MUIPP_TRACE_D(point, ...)
+#endif
+
+#if MUIPP_TRACE_LEVEL >= MUIPP_TRACE_VERBOSE
+#define MUIPP_TRACE_V(point, ...) muipp::trace::record(muipp::trace_point_t::point, ##__VA_ARGS__)
+#else
+#define MUIPP_TRACE_V(point, ...)
+#endif
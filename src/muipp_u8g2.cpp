@@ -1,287 +1,144 @@
 #include "muipp_u8g2.hpp"
+#include <algorithm>
+#include <cstring>
 #include "Arduino.h"
 
-/*
-  display a string on multiple text lines, keeping words intact where possible, and accepting \n to force a new line
-  _Originally posted by @LenShustek in https://github.com/olikraus/u8g2/discussions/1479#discussioncomment-6242771_
-*/
-void printwords(U8G2 &u8g2, const char *msg, int xloc, int yloc /*bottom*/ ) {
-   int dspwidth = u8g2.getDisplayWidth(); // display width in pixels
-   int strwidth = 0;  // string width in pixels
-   char glyph[2]; glyph[1] = 0;
-   for (const char *ptr = msg, *lastblank = NULL; *ptr; ++ptr) {
-      while (xloc == 0 && (*msg == ' ' || *msg == '\n'))
-         if (ptr == msg++) ++ptr; // skip blanks and newlines at the left edge
-      glyph[0] = *ptr;
-      strwidth += u8g2.getStrWidth(glyph); // accumulate the pixel width
-      if (*ptr == ' ')  lastblank = ptr; // remember where the last blank was
-      else ++strwidth; // non-blanks will be separated by one additional pixel
-      if (*ptr == '\n' ||   // if we found a newline character,
-            xloc + strwidth > dspwidth) { // or if we ran past the right edge of the display
-         int starting_xloc = xloc;
-         // print to just before the last blank, or to just before where we got to
-         while (msg < (lastblank ? lastblank : ptr)) {
-            glyph[0] = *msg++;
-            xloc += u8g2.drawStr(xloc, yloc, glyph); }
-         strwidth -= xloc - starting_xloc; // account for what we printed
-         yloc += u8g2.getMaxCharHeight(); // advance to the next line
-         xloc = 0; lastblank = NULL; } }
-   while (*msg) { // print any characters left over
-      glyph[0] = *msg++;
-      xloc += u8g2.drawStr(xloc, yloc, glyph); } 
+bool muipp::BitmapCache::supported(U8G2 &u8g2){
+  return u8g2.getU8g2()->ll_hvline == u8g2_ll_hvline_vertical_top_lsb && u8g2.getBufferTileHeight() * 8 >= u8g2.getDisplayHeight();
 }
 
+bool muipp::BitmapCache::_draw(U8G2 &u8g2, const void* key){
+  if (!_key || _key != key || !supported(u8g2)) return false;
 
-
-u8g2_uint_t Item_U8g2_Generic::getXoffset(u8g2_uint_t x, text_align_t halign, text_align_t valign, const char* text){
-  // set vertical position for cursor
-  switch (valign){
-    case text_align_t::top :
-      _u8g2.setFontPosTop();
-      break;
-    case text_align_t::center :
-      _u8g2.setFontPosCenter();
-      break;
-    case text_align_t::bottom :
-      _u8g2.setFontPosBottom();
-      break;
-    default:
-      _u8g2.setFontPosBaseline();
-  }
-
-  u8g2_uint_t xadj;
-  // find horizontal position for cursor
-  switch (halign){
-    // try to align text centered to defined _x, _y point
-    case text_align_t::center :
-      xadj = x - _u8g2.getUTF8Width(text)/2;
-      break;
-    // calculate left offset from the specified x position to fit the string
-    case text_align_t::right :
-      xadj = x - _u8g2.getUTF8Width(text);
-      break;
-    default:
-      xadj = x;
+  const size_t stride = u8g2.getBufferTileWidth() * 8;
+  uint8_t* buf = u8g2.getBufferPtr() + _row * stride + _x;
+  const uint8_t* src = _bits.data();
+  for (int r = 0; r != _rows; ++r, buf += stride, src += _w){
+    for (int i = 0; i != _w; ++i)
+      buf[i] |= src[i];
   }
-
-  return xadj;
+  return true;
 }
 
+void muipp::BitmapCache::_capture(U8G2 &u8g2, const void* key, const mui_rect& area, action_cb_t render){
+  _key = nullptr;
+  if (!supported(u8g2)) return;
+
+  // glyphs might slightly overflow font reference height, take some margin
+  mui_rect a(area.x - 2, area.y - 2, area.w + 4, area.h + 4);
+  const int tw = u8g2.getBufferTileWidth(), th = u8g2.getBufferTileHeight();
+  a.intersect(mui_rect(0, 0, tw * 8, th * 8));
+  if (a.empty()) return;
+
+  _x = a.x;
+  _w = a.w;
+  _row = a.y / 8;
+  _rows = (a.y + a.h + 7) / 8 - _row;
+  _bits.resize(_w * _rows);
+
+  const size_t stride = tw * 8;
+  uint8_t* buf = u8g2.getBufferPtr() + _row * stride + _x;
+
+  // save the area into image storage and clear it, so that only item's own pixels are captured
+  for (int r = 0; r != _rows; ++r){
+    std::memcpy(_bits.data() + r * _w, buf + r * stride, _w);
+    std::memset(buf + r * stride, 0, _w);
+  }
 
-void MuiItem_U8g2_PageTitle::render(const MuiItem* parent){
-  if (_font)
-    _u8g2.setFont(_font);
-
-  auto a = getXoffset(parent->getName());
-  _u8g2.drawUTF8(a, _y, parent->getName());
-}
+  render();
 
-void MuiItem_U8g2_StaticText::render(const MuiItem* parent){
-  if (_font)
-    _u8g2.setFont(_font);
-  // print text with word-wrap
-  printwords(_u8g2, name, _x, _y);
+  // swap captured pixels with saved content, merging it back into the buffer
+  for (int r = 0; r != _rows; ++r){
+    uint8_t* row = buf + r * stride;
+    uint8_t* bits = _bits.data() + r * _w;
+    for (int i = 0; i != _w; ++i){
+      const uint8_t captured = row[i];
+      row[i] = captured | bits[i];
+      bits[i] = captured;
+    }
+  }
+  _key = key;
 }
 
-void MuiItem_U8g2_TextCallBack::render(const MuiItem* parent){
-  if (_font)
-    _u8g2.setFont(_font);
 
-  auto a = getXoffset(name);
-  _u8g2.drawUTF8(a, _y, _cb());
-  //Serial.printf("TextCallBack: %s\n", _cb());
+mui_rect muipp::renderPartial(MuiPlusPlus &menu, U8G2 &u8g2){
+  const mui_rect screen(0, 0, u8g2.getDisplayWidth(), u8g2.getDisplayHeight());
+  return menu.renderPartial(screen, [&u8g2](const mui_rect& r){
+    uint8_t color = u8g2.getDrawColor();
+    u8g2.setDrawColor(0);
+    u8g2.drawBox(r.x, r.y, r.w, r.h);
+    u8g2.setDrawColor(color);
+  });
 }
 
-
-void MuiItem_U8g2_ActionButton::render(const MuiItem* parent){
-  if (_font)
-    _u8g2.setFont(_font);
-
-  // draw button
-  auto a = getXoffset(name);
-  _u8g2.drawButtonUTF8(a, _y, focused ? U8G2_BTN_INV : 0, 0, 1, 1, name);
+void muipp::renderPages(MuiPlusPlus &menu, U8G2 &u8g2){
+  const int w = u8g2.getDisplayWidth(), h = u8g2.getBufferTileHeight() * 8;
+  u8g2.firstPage();
+  do {
+    // stripe of the screen that current page buffer holds
+    menu.render(mui_rect(0, u8g2.getBufferCurrTileRow() * 8, w, h));
+  } while (u8g2.nextPage());
 }
 
-mui_event MuiItem_U8g2_ActionButton::muiEvent(mui_event e){
-  switch(e.eid){
-    // actions 'select' and 'enter' will trigger defined event
-    case mui_event_t::select :
-    case mui_event_t::enter :
-      return mui_event(_action);
-  }
-  return {};
+size_t muipp::flushArea(U8G2 &u8g2, const mui_rect& area){
+  const int tw = u8g2.getBufferTileWidth(), th = u8g2.getBufferTileHeight();
+  mui_rect r(area);
+  r.intersect(mui_rect(0, 0, tw * 8, th * 8));
+  if (r.empty()) return 0;
+
+  // tiles covering the area
+  int tx = r.x / 8, ty = r.y / 8;
+  int tx2 = (r.x + r.w + 7) / 8, ty2 = (r.y + r.h + 7) / 8;
+  u8g2.updateDisplayArea(tx, ty, tx2 - tx, ty2 - ty);
+  return (tx2 - tx) * (ty2 - ty);
 }
 
+size_t muipp::TileFlusher::flush(){
+  const size_t tw = _u8g2.getBufferTileWidth(), th = _u8g2.getBufferTileHeight();
+  const size_t row_len = tw * 8;
+  const uint8_t* buf = _u8g2.getBufferPtr();
 
-//template <typename Iter>
-//void listwriter (Iter it, Iter end) {
-//    for (; it!=end; ++it) { /*...*/ }
-//}
-
-void MuiItem_U8g2_DynamicScrollList::render(const MuiItem* parent){
-  Serial.printf("DynScrl print lst of %u items\n", _size_cb());
-
-  _u8g2.setCursor(_x, _y);
-  // specified cursor position will be the top reference for the Title text
-  _u8g2.setFontPosTop();
-
-  // normalize index position which items should be displayed
-  int visible_idx = muipp::clamp(_index - _num_of_rows/2, 0, static_cast<int>(_size_cb()-1) );
-  for (int i = 0; i != _num_of_rows; ++i){
-    // change font for active/inactive row
-    if (visible_idx == _index && _font)
-      _u8g2.setFont(_font);
-    else if (_font2)
-      _u8g2.setFont(_font2);
-
-    // draw button
-    Serial.printf("draw Dynlist_btn %u:%s\n", visible_idx, _cb(visible_idx));
-    _u8g2.drawButtonUTF8(_x, _y + _y_shift*i, visible_idx == _index ? U8G2_BTN_INV : 0, 0, 1, 1, _cb(visible_idx));
-
-    if (++visible_idx >= _size_cb())
-      return;
+  // nothing was sent yet, send everything
+  if (_sent.size() != row_len * th){
+    _u8g2.sendBuffer();
+    _sent.assign(buf, buf + row_len * th);
+    return tw * th;
   }
-}
-
 
-mui_event MuiItem_U8g2_DynamicScrollList::muiEvent(mui_event e){
-  Serial.printf("DynamicScrollList::muiEvent %u\n", static_cast<uint32_t>(e.eid));
-  switch(e.eid){
-    // cursor actions - move to previous position in a list
-    case mui_event_t::moveUp :
-    case mui_event_t::moveLeft : {
-      if (_index)
-        --_index;
-      else
-        _index = _size_cb() - 1;
-      break;
-    }
-    // cursor actions - move to next position in a list
-    case mui_event_t::moveDown :
-    case mui_event_t::moveRight : {
-      ++_index;
-      if (_index == _size_cb() )
-        _index = 0;
-      break;
-    }
-
-    case mui_event_t::enter : {
-      // if dynamic list works as page seletor, we will stich pages here
-      if (listopts.page_selector){
-        // last item in a list acts as "go to previous page"
-        if (listopts.back_on_last && (_index == _size_cb() - 1))
-          return mui_event(mui_event_t::prevPage);
-        else  // otherwise - switch to page by it's label
-          return mui_event(mui_event_t::goPageByName, 0, static_cast<void*>(const_cast<char*>(_cb(_index))) );
+  // in vertical layout (SSD1306 and alike) tile is 8 consecutive bytes,
+  // in horizontal layout tile row consists of 8 pixel lines of one byte per tile
+  const bool vertical = _u8g2.getU8g2()->ll_hvline == u8g2_ll_hvline_vertical_top_lsb;
+
+  size_t sent{0};
+  for (size_t ty = 0; ty != th; ++ty){
+    const uint8_t* row = buf + ty * row_len;
+    uint8_t* prev = _sent.data() + ty * row_len;
+    if (!std::memcmp(row, prev, row_len)) continue;
+
+    // find spans of changed tiles in a row
+    size_t span_begin{0}, span_end{0};     // [begin, end) of current span, empty if equal
+    for (size_t tx = 0; tx != tw; ++tx){
+      bool changed = false;
+      for (size_t b = 0; b != 8 && !changed; ++b){
+        size_t i = vertical ? tx * 8 + b : b * tw + tx;
+        changed = row[i] != prev[i];
       }
-      // otherwise we call a callback function to decide next event action
-      if (_action)
-        _action(_index);
-      break;
+      if (!changed) continue;
+
+      if (span_begin != span_end && tx - span_end > _gap){
+        // gap is too large, send current span and start a new one
+        _u8g2.updateDisplayArea(span_begin, ty, span_end - span_begin, 1);
+        sent += span_end - span_begin;
+        span_begin = tx;
+      } else if (span_begin == span_end)
+        span_begin = tx;
+      span_end = tx + 1;
     }
-
-    // enter acts as escape to release selection
-    case mui_event_t::escape :
-      return mui_event(on_escape);
-  }
-
-  return {};
-}
-
-//  ***
-//  MuiItem_U8g2_CheckBox
-
-void MuiItem_U8g2_CheckBox::render(const MuiItem* parent){
-  _u8g2.setCursor(_x, _y);
-  if (_font)
-    _u8g2.setFont(_font);
-  // specified cursor position will be the bottom reference for the Title text
-  _u8g2.setFontPosBottom();
-
-  int8_t a = _u8g2.getAscent();
-  _u8g2.drawFrame(_x, _y-a, a, a);
-  // draw mark in a checkbox if value is true
-  if (_v){
-    a -= 4;
-    _u8g2.drawBox(_x + 2, _y-a-2, a, a);
-    a += 4;   // not sure how this alignment works :(
-  }
-
-  u8g2_int_t w{0};
-  if (getName()){
-    w = _u8g2.getUTF8Width(getName());
-    a += 4;       /* add gap between the checkbox and the text area */
-    _u8g2.drawUTF8(_x + a, _y, getName());
-  }
-
-  u8g2_DrawButtonFrame(_u8g2.getU8g2(), _x, _y, focused ? U8G2_BTN_INV : 0, w+a, 1, 1);
-}
-
-mui_event MuiItem_U8g2_CheckBox::muiEvent(mui_event e){
-  switch(e.eid){
-    case mui_event_t::enter : {
-      _v = !_v;
-      // call a callback function to submit a new box value
-      if (_action)
-        _action(_v);
-      break;
+    if (span_begin != span_end){
+      _u8g2.updateDisplayArea(span_begin, ty, span_end - span_begin, 1);
+      sent += span_end - span_begin;
     }
+    std::memcpy(prev, row, row_len);
   }
-  // by default, return noop
-  return {};
-}
-
-
-//  ***
-//  MuiItem_U8g2_ValuesList
-
-void MuiItem_U8g2_ValuesList::render(const MuiItem* parent){
-  if (_font)
-    _u8g2.setFont(_font);
-
-  // draw label
-  auto a = getXoffset(name);
-  _u8g2.drawUTF8(a, _y, name);
-
-  // value must be printed right after end of label
-  if (_x == _xval)
-    _xval = _u8g2.getCursorX();
-
-  // draw button - https://github.com/olikraus/u8g2/wiki/u8g2reference#drawbuttonutf8
-  u8g2_uint_t flags = 0;
-  if (selected)
-    flags |= U8G2_BTN_INV;
-  else if (focused)
-    flags |= U8G2_BTN_BW1;
-
-  //if (_val_align == text_align_t::center)
-  //  flags |= U8G2_BTN_HCENTER;
-
-  // calc cursor's offset for value
-  const char* s = _getCurrent();
-  auto vxoff = getXoffset(_xval, _val_halign, v_align, s);
-  // draw button with frame or inversion
-  _u8g2.drawButtonUTF8(vxoff, _y, flags, 0, 2, 2, s);
-}
-
-mui_event MuiItem_U8g2_ValuesList::muiEvent(mui_event e){
-  switch(e.eid){
-    // cursor actions - decr value
-    case mui_event_t::moveUp :
-    case mui_event_t::moveLeft : 
-      _onPrev();
-      break;
-    // cursor actions - incr value
-    case mui_event_t::moveDown :
-    case mui_event_t::moveRight :
-      _onNext();
-      break;
-
-    // enter acts as escape to release selection
-    case mui_event_t::enter :
-      return mui_event(on_escape);
-  }
-
-  // by default, return noop
-  return {};
+  return sent;
 }
@@ -1,36 +1,111 @@
 #pragma once
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <memory>
 #include <string>
 #include "U8g2lib.h"
 #include "muiplusplus.hpp"
+#include "muipp_gfx.hpp"
 
+// number of entries in text width cache, must be a power of 2
+#ifndef MUIPP_TEXT_WIDTH_CACHE_SIZE
+#define MUIPP_TEXT_WIDTH_CACHE_SIZE  16
+#endif
+
+// size of the stack buffer numeric values are formatted to
+#ifndef MUIPP_FORMAT_BUFF_SIZE
+#define MUIPP_FORMAT_BUFF_SIZE  24
+#endif
+
+// size of a label copy kept for each visible row of DynamicScrollList, longer labels are truncated
+#ifndef MUIPP_LIST_LABEL_SIZE
+#define MUIPP_LIST_LABEL_SIZE  32
+#endif
+
+// all callbacks are non-allocating delegates, captured state must fit into MUIPP_DELEGATE_SIZE bytes
 
 // callback function that returns index size
-using size_cb_t = std::function< size_t (void)>;
+using size_cb_t = muipp::delegate< size_t (void)>;
 // callback function that accepts index value
-using index_cb_t = std::function< void (size_t index)>;
+using index_cb_t = muipp::delegate< void (size_t index)>;
+// callback function with no arguments
+using action_cb_t = muipp::delegate< void (void)>;
 // callback that just returns string
-using string_cb_t = std::function< const char* (void)>;
+using string_cb_t = muipp::delegate< const char* (void)>;
 // callback function that accepts index and returns const char* string associated with index
-using stringbyindex_cb_t = std::function< const char* (size_t index)>;
+using stringbyindex_cb_t = muipp::delegate< const char* (size_t index)>;
 // callback function for constrained numeric
 template <typename T>
-using constrain_val_cb_t = std::function< void (muiItemId id, T value, T min, T max, T step)>;
-// stringifying function, it accepts some object value and returns a srting that identifies the value (i.e. convert int to asci, etc...)
+using constrain_val_cb_t = muipp::delegate< void (muiItemId id, T value, T min, T max, T step)>;
+// formatting function, it accepts some object value and writes a null-terminated string that identifies the value into provided buffer
+// (i.e. convert int to asci, etc...), returns length of the string written
+template <typename T>
+using format_cb_t = muipp::delegate< size_t (T value, char* buff, size_t size)>;
+
+namespace muipp {
+
+/**
+ * @brief default value formatter, writes a null-terminated string into buff
+ * integers are converted with std::to_chars, floating point values are printed like std::to_string() does
+ * 
+ * @param value 
+ * @param buff 
+ * @param size buffer size
+ * @return size_t length of the string
+ */
 template <typename T>
-using stringify_cb_t = std::function< std::string (T value)>;
-
-enum class text_align_t {
-  baseline = 0,
-  center,
-  top,
-  bottom,
-  left,
-  right
+size_t format_value(T value, char* buff, size_t size){
+  if (!size) return 0;
+  if constexpr (std::is_integral_v<T>){
+    auto r = std::to_chars(buff, buff + size - 1, value);
+    // value does not fit, print nothing
+    if (r.ec != std::errc()) r.ptr = buff;
+    *r.ptr = 0;
+    return r.ptr - buff;
+  } else {
+    int len = std::snprintf(buff, size, "%f", static_cast<double>(value));
+    return len < 0 ? 0 : clamp(static_cast<size_t>(len), static_cast<size_t>(0), size - 1);
+  }
+}
+
+} // end of namespace muipp
+
+// counters of display state changes requested by items
+struct u8g2_state_stats_t {
+  // changes passed to u8g2
+  uint32_t applied{0};
+  // redundant changes skipped
+  uint32_t avoided{0};
 };
 
-class Item_U8g2_Generic {
+/**
+ * @brief generic drawing item
+ * holds display object reference, font and position, helpers to align and measure text
+ * 
+ * @tparam Gfx drawing backend, see muipp_gfx.hpp
+ */
+template <class Gfx = U8G2>
+class Item_Gfx_Generic {
+  static_assert(muipp::is_gfx_backend_v<Gfx>, "Gfx type does not provide drawing backend members, see muipp_gfx.hpp");
+  static_assert(MUIPP_TEXT_WIDTH_CACHE_SIZE && !(MUIPP_TEXT_WIDTH_CACHE_SIZE & (MUIPP_TEXT_WIDTH_CACHE_SIZE - 1)), "cache size must be power of 2");
+
+  inline static u8g2_state_stats_t _stats;
+
+  struct text_width_t {
+    const uint8_t* font;
+    const char* text;
+    uint32_t hash;
+    u8g2_uint_t width;
+  };
+
+  // direct-mapped cache of text widths, shared by all items of the same backend type
+  inline static text_width_t _text_widths[MUIPP_TEXT_WIDTH_CACHE_SIZE];
+
 protected:
-  U8G2 &_u8g2;
+  Gfx &_gfx;
   const uint8_t* _font;
   // item's initial cursor position
   u8g2_uint_t _x, _y;
@@ -45,12 +120,12 @@ public:
   /**
    * @brief Construct a new MuiItem_U8g2_PageTitle object
    * generic object is NOT selectable!
-   * @param u8g2 reference to display object
+   * @param gfx reference to display object
    * @param id assigned id for the item
    * @param font use font for printing, if null, then do not switch font
    * @param x, y Coordinates of the top left corner to start printing
    */
-  Item_U8g2_Generic(U8G2 &u8g2, const uint8_t* font = nullptr, u8g2_uint_t x = 0, u8g2_uint_t y = 0, text_align_t halign = text_align_t::left, text_align_t valign = text_align_t::baseline) : _u8g2(u8g2), _font(font), _x(x), _y(y), h_align(halign), v_align(valign) {};
+  Item_Gfx_Generic(Gfx &gfx, const uint8_t* font = nullptr, u8g2_uint_t x = 0, u8g2_uint_t y = 0, text_align_t halign = text_align_t::left, text_align_t valign = text_align_t::baseline) : _gfx(gfx), _font(font), _x(x), _y(y), h_align(halign), v_align(valign) {};
 
   u8g2_uint_t getX() const { return _x; }
 
@@ -85,66 +160,222 @@ public:
    */
   u8g2_uint_t getXoffset(const char* text){ return getXoffset(_x, h_align, v_align, text); };
 
+  /**
+   * @brief switch display font, the call is skipped if font is already set (or if it is null)
+   * current state is read from display object, so it stays in sync if user code changes it directly
+   * 
+   * @param font 
+   */
+  void useFont(const uint8_t* font);
+
+  /**
+   * @brief set font vertical reference position, the call is skipped if it is already set
+   * 
+   * @param valign top, center, bottom, any other value - baseline
+   */
+  void useFontPos(text_align_t valign);
+
+  // counters of display state changes made by all items of the backend type, could be reset each frame to get per-frame values
+  static const u8g2_state_stats_t& stateStats(){ return _stats; }
+
+  static void resetStateStats(){ _stats = u8g2_state_stats_t(); }
+
+  /**
+   * @brief get width of UTF8 text for the current font
+   * widths are kept in a small cache shared by all items of the backend type, keyed by font, string pointer and string content hash,
+   * so constant labels are measured only once, while changed content of the same buffer is measured again
+   * 
+   * @param text 
+   * @return u8g2_uint_t text width in pixels
+   */
+  u8g2_uint_t textWidth(const char* text);
+
+  /**
+   * @brief calculate screen area covered by a text printed with current font
+   * 
+   * @param x, y cursor position text is printed at
+   * @param w text width in pixels
+   * @param valign font position used for printing
+   * @param pad extra pixels around the text, i.e. button padding and frame
+   * @return mui_rect 
+   */
+  mui_rect textBox(int x, int y, int w, text_align_t valign, int pad = 0);
+
 };
 
+namespace muipp {
+
+/**
+ * @brief pre-rendered image of an item's area in u8g2 frame buffer
+ * it is captured once in buffer's native layout and later is copied straight into the frame buffer,
+ * so the item does not need to decode font glyphs on every frame.
+ * Captured pixels are OR'ed into the buffer, so it suits items that draw with color 1 over empty background (i.e. text)
+ * @note works only in full buffer mode with vertical tile layout (SSD1306, SH1106 and alike),
+ * otherwise draw() always fails and items are rendered as usual
+ */
+class BitmapCache {
+  // captured frame buffer bytes, _w bytes per each tile row
+  std::vector<uint8_t> _bits;
+  int _x{0}, _w{0};
+  int _row{0}, _rows{0};
+  // what was captured, i.e. pointer to the text
+  const void* _key{nullptr};
+
+  bool _draw(U8G2 &u8g2, const void* key);
+  void _capture(U8G2 &u8g2, const void* key, const mui_rect& area, action_cb_t render);
+
+public:
+  // check if display buffer layout is supported
+  static bool supported(U8G2 &u8g2);
+
+  /**
+   * @brief copy captured image into frame buffer
+   * 
+   * @param gfx display object, U8G2 or a class derived from it, other backends do not expose u8g2 buffer layout
+   * and always fail, so items are rendered as usual
+   * @param key identifies the content, must be the same as it was on capture
+   * @return true if image was drawn
+   * @return false if nothing was captured for the key, item should render itself
+   */
+  template <class Gfx>
+  bool draw(Gfx &gfx, const void* key){
+    if constexpr (std::is_base_of_v<U8G2, Gfx>)
+      return _draw(gfx, key);
+    else
+      return false;
+  }
+
+  /**
+   * @brief render item and capture it's image
+   * area in the buffer is cleared, item is rendered once more and captured, then previous buffer content is merged back.
+   * Image storage is reused for the saved buffer content, so capture allocates only when area size grows
+   * 
+   * @param gfx display object, U8G2 or a class derived from it, nothing is captured for other backends
+   * @param key identifies the content
+   * @param area screen area covered by the item
+   * @param render callback that renders the item
+   */
+  template <class Gfx>
+  void capture(Gfx &gfx, const void* key, const mui_rect& area, action_cb_t render){
+    if constexpr (std::is_base_of_v<U8G2, Gfx>)
+      _capture(gfx, key, area, render);
+  }
+
+  // drop captured image
+  void reset(){ _key = nullptr; _bits.clear(); _bits.shrink_to_fit(); }
+};
+
+} // end of namespace muipp
+
 /**
  * @brief this item will print current page title at top left corner by default
  * title string will be passed here by MuiPlusPlus class renderer
  * 
  */
-class MuiItem_U8g2_PageTitle : public Item_U8g2_Generic, public MuiItem_Uncontrollable {
+template <class Gfx = U8G2>
+class MuiItem_Gfx_PageTitle : public Item_Gfx_Generic<Gfx>, public MuiItem_Uncontrollable {
+protected:
+  using Item_Gfx_Generic<Gfx>::_gfx;
+  using Item_Gfx_Generic<Gfx>::_font;
+  using Item_Gfx_Generic<Gfx>::_y;
+  using Item_Gfx_Generic<Gfx>::v_align;
+  using Item_Gfx_Generic<Gfx>::useFont;
+  using Item_Gfx_Generic<Gfx>::getXoffset;
+  using Item_Gfx_Generic<Gfx>::textBox;
 public:
   /**
    * @brief Construct a new MuiItem_U8g2_PageTitle object
    * 
-   * @param u8g2 refernce to display object
+   * @param gfx reference to display object
    * @param id assigned id for the item
    * @param font use font for printing, if null, then do not switch font
    * @param x, y Coordinates of the top left corner to start printing
    */
-  MuiItem_U8g2_PageTitle(U8G2 &u8g2, muiItemId id, const uint8_t* font = nullptr, u8g2_uint_t x = 0, u8g2_uint_t y = 0)
-    : Item_U8g2_Generic(u8g2, font, x, y),
+  MuiItem_Gfx_PageTitle(Gfx &gfx, muiItemId id, const uint8_t* font = nullptr, u8g2_uint_t x = 0, u8g2_uint_t y = 0)
+    : Item_Gfx_Generic<Gfx>(gfx, font, x, y),
       MuiItem_Uncontrollable(id, nullptr) { v_align = text_align_t::top; };
 
-  //~MuiItem_U8g2_PageTitle(){ Serial.println("d-tor PTitle"); }
+  //~MuiItem_Gfx_PageTitle(){ Serial.println("d-tor PTitle"); }
 
   void render(const MuiItem* parent) override;
+
+  /**
+   * @brief enable pre-rendered bitmap cache for the title
+   * title is rendered once per page and then copied into the frame buffer, see muipp::BitmapCache
+   * 
+   * @param enable 
+   */
+  void setBitmapCache(bool enable){ _bitmap.reset(enable ? new muipp::BitmapCache : nullptr); }
+
+private:
+  std::unique_ptr<muipp::BitmapCache> _bitmap;
+  void _draw(const MuiItem* parent);
 };
 
-class MuiItem_U8g2_StaticText : public Item_U8g2_Generic, public MuiItem_Uncontrollable {
+template <class Gfx = U8G2>
+class MuiItem_Gfx_StaticText : public Item_Gfx_Generic<Gfx>, public MuiItem_Uncontrollable {
+protected:
+  using Item_Gfx_Generic<Gfx>::_gfx;
+  using Item_Gfx_Generic<Gfx>::_font;
+  using Item_Gfx_Generic<Gfx>::_x;
+  using Item_Gfx_Generic<Gfx>::_y;
+  using Item_Gfx_Generic<Gfx>::useFont;
 public:
   /**
    * @brief Construct a new MuiItem_U8g2_PageTitle object
    * 
-   * @param u8g2 refernce to display object
+   * @param gfx reference to display object
    * @param id assigned id for the item
    * @param font use font for printing, if null, then do not switch font
    * @param x, y Coordinates of the top left corner to start printing
    */
-  MuiItem_U8g2_StaticText(U8G2 &u8g2, muiItemId id, const char* txt, const uint8_t* font = nullptr, u8g2_uint_t x = 0, u8g2_uint_t y = 0)
-    : Item_U8g2_Generic(u8g2, font, x, y),
+  MuiItem_Gfx_StaticText(Gfx &gfx, muiItemId id, const char* txt, const uint8_t* font = nullptr, u8g2_uint_t x = 0, u8g2_uint_t y = 0)
+    : Item_Gfx_Generic<Gfx>(gfx, font, x, y),
       MuiItem_Uncontrollable(id, txt) {};
 
   void render(const MuiItem* parent) override;
+
+  /**
+   * @brief enable pre-rendered bitmap cache for the text
+   * text is rendered once and then copied into the frame buffer, see muipp::BitmapCache
+   * 
+   * @param enable 
+   */
+  void setBitmapCache(bool enable){ _bitmap.reset(enable ? new muipp::BitmapCache : nullptr); }
+
+private:
+  std::unique_ptr<muipp::BitmapCache> _bitmap;
+  muipp::TextLayout _layout;
+  void _draw();
 };
 
 
-class MuiItem_U8g2_TextCallBack : public Item_U8g2_Generic, public MuiItem_Uncontrollable {
+template <class Gfx = U8G2>
+class MuiItem_Gfx_TextCallBack : public Item_Gfx_Generic<Gfx>, public MuiItem_Uncontrollable {
+protected:
+  using Item_Gfx_Generic<Gfx>::_gfx;
+  using Item_Gfx_Generic<Gfx>::_font;
+  using Item_Gfx_Generic<Gfx>::_y;
+  using Item_Gfx_Generic<Gfx>::v_align;
+  using Item_Gfx_Generic<Gfx>::useFont;
+  using Item_Gfx_Generic<Gfx>::getXoffset;
+  using Item_Gfx_Generic<Gfx>::textBox;
+private:
   string_cb_t _cb;
 public:
   /**
    * @brief Construct a new MuiItem_U8g2_PageTitle object
    * 
-   * @param u8g2 refernce to display object
+   * @param gfx reference to display object
    * @param id assigned id for the item
    * @param font use font for printing, if null, then do not switch font
    * @param x, y Coordinates of the top left corner to start printing
    */
-  MuiItem_U8g2_TextCallBack(U8G2 &u8g2, muiItemId id, string_cb_t callback,
+  MuiItem_Gfx_TextCallBack(Gfx &gfx, muiItemId id, string_cb_t callback,
       const uint8_t* font = nullptr, u8g2_uint_t x = 0, u8g2_uint_t y = 0,
       text_align_t halign = text_align_t::left,
       text_align_t valign = text_align_t::baseline)
-        : Item_U8g2_Generic(u8g2, font, x, y),
+        : Item_Gfx_Generic<Gfx>(gfx, font, x, y),
           MuiItem_Uncontrollable(id), _cb(callback) {};
 
   void render(const MuiItem* parent) override;
@@ -157,22 +388,32 @@ public:
  * @note item is focusable
  * @note item is NOT selectable
  */
-class MuiItem_U8g2_ActionButton : public Item_U8g2_Generic, public MuiItem {
+template <class Gfx = U8G2>
+class MuiItem_Gfx_ActionButton : public Item_Gfx_Generic<Gfx>, public MuiItem {
 protected:
+  using Item_Gfx_Generic<Gfx>::_gfx;
+  using Item_Gfx_Generic<Gfx>::_font;
+  using Item_Gfx_Generic<Gfx>::_y;
+  using Item_Gfx_Generic<Gfx>::v_align;
+  using Item_Gfx_Generic<Gfx>::useFont;
+  using Item_Gfx_Generic<Gfx>::getXoffset;
+  using Item_Gfx_Generic<Gfx>::textWidth;
+  using Item_Gfx_Generic<Gfx>::textBox;
   mui_event _action;
 public:
-  MuiItem_U8g2_ActionButton(
-    U8G2 &u8g2, muiItemId id,
+  MuiItem_Gfx_ActionButton(
+    Gfx &gfx, muiItemId id,
     mui_event onAction,                                                           // button action
     const char* lbl,                                                              // button label
     const uint8_t* font = nullptr, u8g2_uint_t x = 0, u8g2_uint_t y = 0,          // look and position
     text_align_t halign = text_align_t::left, text_align_t valign = text_align_t::baseline
     )
-    : Item_U8g2_Generic(u8g2, font, x, y, halign, valign),
+    : Item_Gfx_Generic<Gfx>(gfx, font, x, y, halign, valign),
       MuiItem(id, lbl, {false, false}), _action(onAction) {};
 
   // render method
-  void render(const MuiItem* parent) override;
+  void render(const MuiItem* parent) override { renderState(parent, getState()); }
+  void renderState(const MuiItem* parent, const mui_item_state& state) override;
 
   // event handler
   mui_event muiEvent(mui_event e) override;
@@ -184,10 +425,11 @@ public:
  * it will be process by MuiPlusPlus as either switch to previous page or other action if overriden
  * by default it will be placed at down-right corner
  */
-class MuiItem_U8g2_BackButton : public MuiItem_U8g2_ActionButton {
+template <class Gfx = U8G2>
+class MuiItem_Gfx_BackButton : public MuiItem_Gfx_ActionButton<Gfx> {
 public:
-  MuiItem_U8g2_BackButton(U8G2 &u8g2, muiItemId id, const char* lbl, const uint8_t* font = nullptr)
-    : MuiItem_U8g2_ActionButton(u8g2, id, {mui_event_t::prevPage}, lbl, font, u8g2.getDisplayWidth(), u8g2.getDisplayHeight(), text_align_t::right, text_align_t::bottom) {};
+  MuiItem_Gfx_BackButton(Gfx &gfx, muiItemId id, const char* lbl, const uint8_t* font = nullptr)
+    : MuiItem_Gfx_ActionButton<Gfx>(gfx, id, {mui_event_t::prevPage}, lbl, font, gfx.getDisplayWidth(), gfx.getDisplayHeight(), text_align_t::right, text_align_t::bottom) {};
 };
 
 
@@ -211,11 +453,24 @@ struct dynlist_options_t {
  * -------
  * 
  * @note if 'opts.page_selector' flag is set, then list will act as a page switcher,
- * i.e. on 'enter' event it will try to switch to a page with name matching to selected list label
+ * i.e. on 'enter' event it will try to switch to a page with name matching to selected list label,
+ * or to a page id bound to list index with bindPage()
  * @note if 'opts.back_on_last' flag is set, then last element of a list will act 'back' event and switch to a previous page
+ * @note list size is queried once per event or frame, labels of visible rows are copied into a per-row cache and requested
+ * from label callback only when rows are scrolled into view, call refresh() or setVersion() when list data changes.
+ * Label callback could reuse the same buffer for each call, labels longer than MUIPP_LIST_LABEL_SIZE - 1 bytes are truncated
  * 
  */
-class MuiItem_U8g2_DynamicScrollList : public Item_U8g2_Generic, public MuiItem {
+template <class Gfx = U8G2>
+class MuiItem_Gfx_DynamicScrollList : public Item_Gfx_Generic<Gfx>, public MuiItem {
+protected:
+  using Item_Gfx_Generic<Gfx>::_gfx;
+  using Item_Gfx_Generic<Gfx>::_font;
+  using Item_Gfx_Generic<Gfx>::_x;
+  using Item_Gfx_Generic<Gfx>::_y;
+  using Item_Gfx_Generic<Gfx>::useFont;
+  using Item_Gfx_Generic<Gfx>::useFontPos;
+private:
   stringbyindex_cb_t _cb;
   size_cb_t _size_cb;
   index_cb_t _action;
@@ -223,12 +478,31 @@ class MuiItem_U8g2_DynamicScrollList : public Item_U8g2_Generic, public MuiItem
   const uint8_t *_font2;
   // current list index
   int _index{0};
+  // pre-resolved page ids for page selector, position in vector matches list index
+  std::vector<muiItemId> _pages;
+  // copy of a visible row label
+  struct row_label_t {
+    bool fetched;
+    char text[MUIPP_LIST_LABEL_SIZE];
+  };
+  // labels of visible rows, starting from list index _first
+  std::vector<row_label_t> _labels;
+  int _first{0};
+  size_t _cache_size{0};
+  // data version, cache is dropped when it does not match the one labels were fetched for
+  std::atomic<uint32_t> _version{0};
+  uint32_t _cache_version{0};
+
+  // get label for list index via cache, visible window must be already aligned with _first
+  const char* _label(int idx);
+  // shift cached window to a new first visible index, dropping stale labels
+  void _scroll(int first, size_t size);
 
 public:
   /**
    * @brief Construct a MuiItem_U8g2_DynamicScrollList object
    * 
-   * @param u8g2 reference to display object
+   * @param gfx reference to display object
    * @param id assigned id for the item
    * @param label_cb function that returns const char* for the specified label index
    * @param action_cb function called with index of an active element in a list when "enter" event is received
@@ -239,7 +513,7 @@ public:
    * @param font2 font to use for other rows, same as font1 if null
    * @param x, y Coordinates of the top left corner to start printing
    */
-  MuiItem_U8g2_DynamicScrollList(U8G2 &u8g2,
+  MuiItem_Gfx_DynamicScrollList(Gfx &gfx,
       muiItemId id,
       stringbyindex_cb_t label_cb,
       size_cb_t count,
@@ -250,16 +524,46 @@ public:
       const uint8_t* font1 = nullptr,
       const uint8_t* font2 = nullptr
   )
-    : Item_U8g2_Generic(u8g2, font1, x, y),
-      MuiItem(id, nullptr), _cb(label_cb), _size_cb(count), _action(action_cb), _y_shift(y_shift), _num_of_rows(num_of_rows), _font2(font2) {};
+    : Item_Gfx_Generic<Gfx>(gfx, font1, x, y),
+      MuiItem(id, nullptr), _cb(label_cb), _size_cb(count), _action(action_cb), _y_shift(y_shift), _num_of_rows(num_of_rows), _font2(font2),
+      _labels(num_of_rows) {};
 
   // list options
   dynlist_options_t listopts;
 
+  /**
+   * @brief bind list index to a page id
+   * if 'listopts.page_selector' is set, then on 'enter' event list will switch to the bound page by it's id
+   * instead of resolving a page by label name
+   * 
+   * @param index list index
+   * @param page_id page id to switch to, 0 - unbind and use label lookup
+   */
+  void bindPage(size_t index, muiItemId page_id);
+
+  /**
+   * @brief drop cached labels, those will be re-requested on next render
+   * should be called when list data has changed
+   */
+  void refresh(){ _version.fetch_add(1); invalidate(); }
+
+  /**
+   * @brief set list data version
+   * cached labels are dropped if version differs from the previous one,
+   * i.e. it could be a change counter of the data source
+   * 
+   * @param version 
+   */
+  void setVersion(uint32_t version){ if (_version.exchange(version) != version) invalidate(); }
+
   // event handler
   mui_event muiEvent(mui_event e) override;
 
-  void render(const MuiItem* parent) override;
+  // list index is captured in render state
+  mui_item_state getState() const override { auto s = MuiItem::getState(); s.set(_index); return s; }
+
+  void render(const MuiItem* parent) override { renderState(parent, getState()); }
+  void renderState(const MuiItem* parent, const mui_item_state& state) override;
 };
 
 /**
@@ -267,7 +571,18 @@ public:
  * and will call a callback function on action event
  * 
  */
-class MuiItem_U8g2_CheckBox : public Item_U8g2_Generic, public MuiItem {
+template <class Gfx = U8G2>
+class MuiItem_Gfx_CheckBox : public Item_Gfx_Generic<Gfx>, public MuiItem {
+protected:
+  using Item_Gfx_Generic<Gfx>::_gfx;
+  using Item_Gfx_Generic<Gfx>::_font;
+  using Item_Gfx_Generic<Gfx>::_x;
+  using Item_Gfx_Generic<Gfx>::_y;
+  using Item_Gfx_Generic<Gfx>::useFont;
+  using Item_Gfx_Generic<Gfx>::useFontPos;
+  using Item_Gfx_Generic<Gfx>::textWidth;
+  using Item_Gfx_Generic<Gfx>::textBox;
+private:
   // checkbox value
   bool _v;
   index_cb_t _action;
@@ -275,43 +590,62 @@ public:
   /**
    * @brief Construct a new MuiItem_U8g2_PageTitle object
    * 
-   * @param u8g2 reference to display object
+   * @param gfx reference to display object
    * @param id assigned id for the item
    * @param font use font for printing, if null, then do not switch font
    * @param x, y Coordinates of the top left corner to start printing
    */
-  MuiItem_U8g2_CheckBox(U8G2 &u8g2, muiItemId id, const char* label, bool value, index_cb_t action_cb = nullptr, const uint8_t* font = nullptr, u8g2_uint_t x = 0, u8g2_uint_t y = 0)
-    : Item_U8g2_Generic(u8g2, font, x, y),
+  MuiItem_Gfx_CheckBox(Gfx &gfx, muiItemId id, const char* label, bool value, index_cb_t action_cb = nullptr, const uint8_t* font = nullptr, u8g2_uint_t x = 0, u8g2_uint_t y = 0)
+    : Item_Gfx_Generic<Gfx>(gfx, font, x, y),
       MuiItem(id, label, {false, false}),_v(value), _action(action_cb){}
 
+  // checkbox value is captured in render state
+  mui_item_state getState() const override { auto s = MuiItem::getState(); s.set(_v); return s; }
+
   // render method
-  void render(const MuiItem* parent) override;
+  void render(const MuiItem* parent) override { renderState(parent, getState()); }
+  void renderState(const MuiItem* parent, const mui_item_state& state) override;
   // event handler
   mui_event muiEvent(mui_event e) override;
 };
 
 
-template <typename T>
-class MuiItem_U8g2_NumberHSlide : public Item_U8g2_Generic, public MuiItem {
+template <typename T, class Gfx = U8G2>
+class MuiItem_Gfx_NumberHSlide : public Item_Gfx_Generic<Gfx>, public MuiItem {
+protected:
+  using Item_Gfx_Generic<Gfx>::_gfx;
+  using Item_Gfx_Generic<Gfx>::_font;
+  using Item_Gfx_Generic<Gfx>::_x;
+  using Item_Gfx_Generic<Gfx>::_y;
+  using Item_Gfx_Generic<Gfx>::useFont;
+  using Item_Gfx_Generic<Gfx>::useFontPos;
+  using Item_Gfx_Generic<Gfx>::textBox;
+private:
   // integer value
   //const char* _format;
   T& _v;
   T _minv, _maxv, _step;
-  stringify_cb_t<T>     _mkstring;
+  format_cb_t<T>        _format;
   constrain_val_cb_t<T> _onSelect;
   constrain_val_cb_t<T> _onDeSelect;
   constrain_val_cb_t<T> _onChange;
   const uint8_t* _font2;   // font for minor values
   u8g2_uint_t _offset;
 
-  void _rndr_unformatted(const MuiItem* parent);
-  void _rndr_formatted(const MuiItem* parent);
+  // format value into buffer with user formatter or default one
+  const char* _print(T value, char* buff) const {
+    if (!_format || !_format(value, buff, MUIPP_FORMAT_BUFF_SIZE)) muipp::format_value(value, buff, MUIPP_FORMAT_BUFF_SIZE);
+    return buff;
+  }
+
+  // move value by a number of steps, bounded value saturates at range ends without wrapping over for unsigned types
+  void _move(bool up, uint32_t count);
 
 public:
   /**
    * @brief Construct a new MuiItem_U8g2_NumberHSlide object
    * 
-   * @param u8g2 display object
+   * @param gfx display object
    * @param id item id
    * @param label text label
    * @param value reference to adjustment variable
@@ -325,39 +659,55 @@ public:
    * @param x 
    * @param y 
    */
-  MuiItem_U8g2_NumberHSlide(
-    U8G2 &u8g2,
+  MuiItem_Gfx_NumberHSlide(
+    Gfx &gfx,
     muiItemId id,
     const char* label,
     T& value,
     T min, T max, T step,
-    stringify_cb_t<T> makeString = nullptr,
+    format_cb_t<T> format = nullptr,
     constrain_val_cb_t<T> onSelect = nullptr,
     constrain_val_cb_t<T> onDeSelect = nullptr,
     constrain_val_cb_t<T> onChange = nullptr,
     const uint8_t* font1 = nullptr,
     const uint8_t* font2 = nullptr,
     u8g2_uint_t x = 0, u8g2_uint_t y = 0, u8g2_uint_t offset = 20)
-    : Item_U8g2_Generic(u8g2, font1, x, y),
+    : Item_Gfx_Generic<Gfx>(gfx, font1, x, y),
       MuiItem(id, label),
       _v(value), _minv(min), _maxv(max), _step(step),
-      _mkstring(makeString), _onSelect(onSelect), _onDeSelect(onDeSelect), _onChange(onChange),
+      _format(format), _onSelect(onSelect), _onDeSelect(onDeSelect), _onChange(onChange),
       _font2(font2), _offset(offset) { }
 
-  //~MuiItem_U8g2_NumberHSlide(){ Serial.println("d-tor HSlide"); }
+  //~MuiItem_Gfx_NumberHSlide(){ Serial.println("d-tor HSlide"); }
+
+  // current value is captured in render state
+  mui_item_state getState() const override { auto s = MuiItem::getState(); s.set(_v); return s; }
 
   // render method
-  void render(const MuiItem* parent) override;
+  void render(const MuiItem* parent) override { renderState(parent, getState()); }
+  void renderState(const MuiItem* parent, const mui_item_state& state) override;
   // event handler
   mui_event muiEvent(mui_event e) override;
 };
 
 
-class MuiItem_U8g2_ValuesList : public Item_U8g2_Generic, public MuiItem {
+template <class Gfx = U8G2>
+class MuiItem_Gfx_ValuesList : public Item_Gfx_Generic<Gfx>, public MuiItem {
+protected:
+  using Item_Gfx_Generic<Gfx>::_gfx;
+  using Item_Gfx_Generic<Gfx>::_font;
+  using Item_Gfx_Generic<Gfx>::_x;
+  using Item_Gfx_Generic<Gfx>::_y;
+  using Item_Gfx_Generic<Gfx>::v_align;
+  using Item_Gfx_Generic<Gfx>::useFont;
+  using Item_Gfx_Generic<Gfx>::getXoffset;
+  using Item_Gfx_Generic<Gfx>::textWidth;
+  using Item_Gfx_Generic<Gfx>::textBox;
+private:
   // callbacks
   string_cb_t _getCurrent;
-  std::function< void (void)> _onNext;
-  std::function< void (void)> _onPrev;
+  action_cb_t _onNext;
+  action_cb_t _onPrev;
   // cursor x position for value 
   u8g2_uint_t _xval;
   // value horizontal alignment
@@ -365,82 +715,299 @@ class MuiItem_U8g2_ValuesList : public Item_U8g2_Generic, public MuiItem {
 
 public:
 
-  MuiItem_U8g2_ValuesList(
-    U8G2 &u8g2,
+  MuiItem_Gfx_ValuesList(
+    Gfx &gfx,
     muiItemId id,
     const char* label,
     string_cb_t getCurrent,
-    std::function< void (void)> onNext,
-    std::function< void (void)> onPrevious,
+    action_cb_t onNext,
+    action_cb_t onPrevious,
     u8g2_uint_t xlbl, u8g2_uint_t xval,
     u8g2_uint_t y,
     const uint8_t* font = nullptr,
     text_align_t lbl = text_align_t::left,
     text_align_t val_halign = text_align_t::left,
     text_align_t valign = text_align_t::baseline
-  ) : Item_U8g2_Generic(u8g2, font, xlbl, y, lbl, valign),
+  ) : Item_Gfx_Generic<Gfx>(gfx, font, xlbl, y, lbl, valign),
       MuiItem(id, label), _getCurrent(getCurrent), _onNext(onNext), _onPrev(onPrevious), _xval(xval), _val_halign(val_halign) {}
 
   // render method
-  void render(const MuiItem* parent) override;
+  void render(const MuiItem* parent) override { renderState(parent, getState()); }
+  void renderState(const MuiItem* parent, const mui_item_state& state) override;
   // event handler
   mui_event muiEvent(mui_event e) override;
 };
 
+// items drawing on U8G2 displays, names are kept from the time items were not templated over a drawing backend
+using Item_U8g2_Generic = Item_Gfx_Generic<U8G2>;
+using MuiItem_U8g2_PageTitle = MuiItem_Gfx_PageTitle<U8G2>;
+using MuiItem_U8g2_StaticText = MuiItem_Gfx_StaticText<U8G2>;
+using MuiItem_U8g2_TextCallBack = MuiItem_Gfx_TextCallBack<U8G2>;
+using MuiItem_U8g2_ActionButton = MuiItem_Gfx_ActionButton<U8G2>;
+using MuiItem_U8g2_BackButton = MuiItem_Gfx_BackButton<U8G2>;
+using MuiItem_U8g2_DynamicScrollList = MuiItem_Gfx_DynamicScrollList<U8G2>;
+using MuiItem_U8g2_CheckBox = MuiItem_Gfx_CheckBox<U8G2>;
+template <typename T>
+using MuiItem_U8g2_NumberHSlide = MuiItem_Gfx_NumberHSlide<T, U8G2>;
+using MuiItem_U8g2_ValuesList = MuiItem_Gfx_ValuesList<U8G2>;
+
+namespace muipp {
+
+/**
+ * @brief render only changed items of the menu into u8g2 frame buffer
+ * changed area is cleared in the buffer and redrawn, see MuiPlusPlus::renderPartial()
+ * 
+ * @param menu 
+ * @param u8g2 
+ * @return mui_rect area of the buffer that has been changed
+ */
+mui_rect renderPartial(MuiPlusPlus &menu, U8G2 &u8g2);
+
+/**
+ * @brief render menu in u8g2 page buffer mode (_1_/_2_ constructors)
+ * it runs firstPage()/nextPage() loop and renders each item only on page stripes that item's area intersects,
+ * it works in full buffer mode as well, then the whole screen is a single page
+ * 
+ * @param menu 
+ * @param u8g2 
+ */
+void renderPages(MuiPlusPlus &menu, U8G2 &u8g2);
+
+/**
+ * @brief send to display only 8x8 tiles covering specified area of the frame buffer
+ * @note works in full buffer mode only
+ * 
+ * @param u8g2 
+ * @param area i.e. area returned by renderPartial()
+ * @return size_t number of tiles sent
+ */
+size_t flushArea(U8G2 &u8g2, const mui_rect& area);
+
+/**
+ * @brief sends to display only those tiles of the frame buffer that differ from previously sent frame
+ * it keeps a copy of the last sent buffer and compares it tile by tile, changed tiles in each tile row are sent
+ * with updateDisplayArea() in spans, so unchanged parts of the screen are never transferred over the bus
+ * @note works in full buffer mode only
+ */
+class TileFlusher {
+  U8G2 &_u8g2;
+  // copy of the frame buffer that was last sent to display
+  std::vector<uint8_t> _sent;
+  // merge changed tiles into a single span if gap between those is shorter than this
+  uint8_t _gap;
+
+public:
+  /**
+   * @brief Construct a new Tile Flusher object
+   * 
+   * @param u8g2 display object
+   * @param gap max number of unchanged tiles that are sent anyway to join two changed spans in a row,
+   * each new span costs a few bytes of addressing commands
+   */
+  TileFlusher(U8G2 &u8g2, uint8_t gap = 1) : _u8g2(u8g2), _gap(gap) {}
+
+  /**
+   * @brief send changed tiles to display
+   * first call sends the whole buffer
+   * 
+   * @return size_t number of tiles sent
+   */
+  size_t flush();
+
+  // forget last sent frame, next flush() will send the whole buffer, i.e. after display was reset
+  void reset(){ _sent.clear(); }
+};
+
+} // end of namespace muipp
+
 // ***********************************
 
 //    templates implementations
 
 // ***********************************
-template <typename T>
-void MuiItem_U8g2_NumberHSlide<T>::render(const MuiItem* parent){
-  _u8g2.setFontPosCenter();
-  std::string val_str(_mkstring ? _mkstring(_v) : std::to_string(_v) );
-  if (_font)
-    _u8g2.setFont(_font);
-  auto vlen = _u8g2.getStrWidth(val_str.data());
-
-  // check if prev value step is valid, then print it
-  if ( (_minv != _maxv) && ((_v - _step) >= _minv) ){
-    if (_font2)
-      _u8g2.setFont(_font2);
-
-    std::string pval_str(_mkstring ? _mkstring(_v - _step) : std::to_string(_v - _step));
-    auto prevx = _x - vlen/2 - _offset - _u8g2.getStrWidth(pval_str.data());
-    _u8g2.setCursor(prevx, _y);
-    _u8g2.print(pval_str.data());
+template <class Gfx>
+void Item_Gfx_Generic<Gfx>::useFont(const uint8_t* font){
+  if (!font) return;
+  if (muipp::currentFont(_gfx) == font){
+    ++_stats.avoided;
+    return;
+  }
+  _gfx.setFont(font);
+  ++_stats.applied;
+}
+
+template <class Gfx>
+void Item_Gfx_Generic<Gfx>::useFontPos(text_align_t valign){
+  const text_align_t pos = muipp::currentFontPos(_gfx);
+  switch (valign){
+    case text_align_t::top :
+      if (pos == text_align_t::top) break;
+      _gfx.setFontPosTop();
+      ++_stats.applied;
+      return;
+    case text_align_t::center :
+      if (pos == text_align_t::center) break;
+      _gfx.setFontPosCenter();
+      ++_stats.applied;
+      return;
+    case text_align_t::bottom :
+      if (pos == text_align_t::bottom) break;
+      _gfx.setFontPosBottom();
+      ++_stats.applied;
+      return;
+    default:
+      if (pos == text_align_t::baseline) break;
+      _gfx.setFontPosBaseline();
+      ++_stats.applied;
+      return;
   }
+  ++_stats.avoided;
+}
+
+template <class Gfx>
+u8g2_uint_t Item_Gfx_Generic<Gfx>::getXoffset(u8g2_uint_t x, text_align_t halign, text_align_t valign, const char* text){
+  // set vertical position for cursor
+  useFontPos(valign);
+
+  u8g2_uint_t xadj;
+  // find horizontal position for cursor
+  switch (halign){
+    // try to align text centered to defined _x, _y point
+    case text_align_t::center :
+      xadj = x - textWidth(text)/2;
+      break;
+    // calculate left offset from the specified x position to fit the string
+    case text_align_t::right :
+      xadj = x - textWidth(text);
+      break;
+    default:
+      xadj = x;
+  }
+
+  return xadj;
+}
+
+template <class Gfx>
+u8g2_uint_t Item_Gfx_Generic<Gfx>::textWidth(const char* text){
+  if (!text) return 0;
+  const uint8_t* font = muipp::currentFont(_gfx);
+
+  uint32_t hash = muipp::str_hash(text);
+
+  text_width_t &e = _text_widths[(hash ^ reinterpret_cast<uintptr_t>(font) ^ reinterpret_cast<uintptr_t>(text)) & (MUIPP_TEXT_WIDTH_CACHE_SIZE - 1)];
+  if (e.font != font || e.text != text || e.hash != hash){
+    e.font = font;
+    e.text = text;
+    e.hash = hash;
+    e.width = _gfx.getUTF8Width(text);
+  }
+  return e.width;
+}
+
+template <class Gfx>
+mui_rect Item_Gfx_Generic<Gfx>::textBox(int x, int y, int w, text_align_t valign, int pad){
+  int asc = _gfx.getAscent(), desc = _gfx.getDescent();
+  // baseline offset from cursor position, same as u8g2 calculates it for font reference position
+  int base;
+  switch (valign){
+    case text_align_t::top :
+      base = asc;
+      break;
+    case text_align_t::center :
+      base = (asc - desc) / 2 + desc;
+      break;
+    case text_align_t::bottom :
+      base = desc;
+      break;
+    default:
+      base = 0;
+  }
+  return mui_rect(x - pad, y + base - asc - pad, w + 2*pad, asc - desc + 2*pad);
+}
+
+template <typename T, class Gfx>
+void MuiItem_Gfx_NumberHSlide<T, Gfx>::renderState(const MuiItem* parent, const mui_item_state& state){
+  const T v = state.get<T>();
+  useFontPos(text_align_t::center);
+  // values are formatted into stack buffers, no allocations on render
+  char val_str[MUIPP_FORMAT_BUFF_SIZE], side_str[MUIPP_FORMAT_BUFF_SIZE];
+  _print(v, val_str);
+  useFont(_font);
+  auto vlen = _gfx.getUTF8Width(val_str);
+
+  // check if prev value step is valid, then print it, compare before subtracting, unsigned value must not wrap around
+  if ( (_minv != _maxv) && v >= _minv && (v - _minv) >= _step ){
+    useFont(_font2);
+
+    _print(v - _step, side_str);
+    auto prevx = _x - vlen/2 - _offset - _gfx.getUTF8Width(side_str);
+    _bbox = textBox(prevx, _y, _gfx.drawUTF8(prevx, _y, side_str), text_align_t::center);
+  } else
+    _bbox = mui_rect();
 
   // print value string
-  if (_font)
-    _u8g2.setFont(_font);
+  useFont(_font);
 
-  _u8g2.drawButtonUTF8(_x - vlen/2, _y, U8G2_BTN_INV, 0, 1, 1, val_str.data());
+  _gfx.drawButtonUTF8(_x - vlen/2, _y, U8G2_BTN_INV, 0, 1, 1, val_str);
+  _bbox.unite(textBox(_x - vlen/2, _y, vlen, text_align_t::center, 2));
 
 
-  // check if next value step is valid, then print it
-  if ( (_minv != _maxv) && (_v + _step <= _maxv)){
-    if (_font2)
-      _u8g2.setFont(_font2);
-    _u8g2.setCursor(_x + vlen/2 + _offset, _y);
-    std::string nval_str( _mkstring ? _mkstring(_v + _step) : std::to_string(_v + _step));
-    _u8g2.print(nval_str.data());
+  // check if next value step is valid, then print it, compare before adding
+  if ( (_minv != _maxv) && v <= _maxv && (_maxv - v) >= _step ){
+    useFont(_font2);
+    const int nextx = _x + vlen/2 + _offset;
+    _bbox.unite(textBox(nextx, _y, _gfx.drawUTF8(nextx, _y, _print(v + _step, side_str)), text_align_t::center));
   }
 }
 
-template <typename T>
-mui_event MuiItem_U8g2_NumberHSlide<T>::muiEvent(mui_event e){
+template <typename T, class Gfx>
+void MuiItem_Gfx_NumberHSlide<T, Gfx>::_move(bool up, uint32_t count){
+  // unconstrained value
+  if (_minv == _maxv){
+    T delta = _step * static_cast<T>(count);
+    _v = up ? _v + delta : _v - delta;
+    return;
+  }
+
+  const T v = muipp::clamp(_v, _minv, _maxv);
+  const T range = _maxv - _minv;
+  // more steps than fits into the range would saturate anyway, do not let step*count overflow
+  bool fits = false;
+  if (_step > 0){
+    // count is not narrowed to T, it might not fit into small integer types
+    if constexpr (std::is_integral_v<T>)
+      fits = static_cast<uint64_t>(range / _step) >= count;
+    else
+      fits = range / _step >= static_cast<T>(count);
+  }
+  const T delta = fits ? static_cast<T>(_step * static_cast<T>(count)) : range;
+  // compare against the bounds before adding/subtracting
+  if (up)
+    _v = _maxv - v < delta ? _maxv : static_cast<T>(v + delta);
+  else
+    _v = v - _minv < delta ? _minv : static_cast<T>(v - delta);
+}
+
+template <typename T, class Gfx>
+mui_event MuiItem_Gfx_NumberHSlide<T, Gfx>::muiEvent(mui_event e){
+  const T prev = _v;
   switch(e.eid){
     // cursor actions - incr/decr value
     case mui_event_t::moveUp :
     case mui_event_t::moveLeft : {
-      _v = (_minv != _maxv) ? muipp::clamp(_v - _step, _minv, _maxv) : _v - _step;
+      _move(false, 1);
       break;
     }
     // cursor actions - incr/decr value
     case mui_event_t::moveDown :
     case mui_event_t::moveRight : {
-      _v = (_minv != _maxv) ? muipp::clamp(_v + _step, _minv, _maxv) : _v + _step;
+      _move(true, 1);
+      break;
+    }
+
+    // coalesced cursor actions - incr/decr value by a number of steps at once
+    case mui_event_t::step : {
+      _move(e.param > 0, static_cast<uint32_t>(e.param < 0 ? -static_cast<int64_t>(e.param) : e.param));
       break;
     }
 
@@ -455,8 +1022,357 @@ mui_event MuiItem_U8g2_NumberHSlide<T>::muiEvent(mui_event e){
       return mui_event(on_escape);
       break;
     }
+    default:
+      break;
   }
 
+  // clamped value might not change at all, i.e. moving up at the top of the range
+  if (_v != prev)
+    invalidate();
+
   // no-op
   return {};
 }
+
+template <class Gfx>
+void MuiItem_Gfx_PageTitle<Gfx>::render(const MuiItem* parent){
+  // title does not change for a page, so page name is a key
+  if (_bitmap && _bitmap->draw(_gfx, parent->getName()))
+    return;
+  _draw(parent);
+  if (_bitmap)
+    _bitmap->capture(_gfx, parent->getName(), _bbox, [this, parent](){ _draw(parent); });
+}
+
+template <class Gfx>
+void MuiItem_Gfx_PageTitle<Gfx>::_draw(const MuiItem* parent){
+  useFont(_font);
+
+  auto a = getXoffset(parent->getName());
+  _bbox = textBox(a, _y, _gfx.drawUTF8(a, _y, parent->getName()), v_align);
+}
+
+template <class Gfx>
+void MuiItem_Gfx_StaticText<Gfx>::render(const MuiItem* parent){
+  if (_bitmap && _bitmap->draw(_gfx, name))
+    return;
+  _draw();
+  if (_bitmap)
+    _bitmap->capture(_gfx, name, _bbox, [this](){ _draw(); });
+}
+
+template <class Gfx>
+void MuiItem_Gfx_StaticText<Gfx>::_draw(){
+  useFont(_font);
+  // print text with word-wrap, line breaks are recomputed only on text or font change
+  _layout.update(_gfx, name, _x, _gfx.getDisplayWidth());
+  int last = _layout.draw(_gfx, _y);
+  // wrapped lines start from the left edge of the screen, font position is not known here, so take a full line gap around
+  int h = _gfx.getMaxCharHeight();
+  _bbox = mui_rect(0, _y - h, _gfx.getDisplayWidth(), last - _y + 2*h);
+}
+
+template <class Gfx>
+void MuiItem_Gfx_TextCallBack<Gfx>::render(const MuiItem* parent){
+  useFont(_font);
+
+  auto a = getXoffset(name);
+  _bbox = textBox(a, _y, _gfx.drawUTF8(a, _y, _cb()), v_align);
+  //Serial.printf("TextCallBack: %s\n", _cb());
+}
+
+
+template <class Gfx>
+void MuiItem_Gfx_ActionButton<Gfx>::renderState(const MuiItem* parent, const mui_item_state& state){
+  useFont(_font);
+
+  // draw button
+  auto a = getXoffset(name);
+  _gfx.drawButtonUTF8(a, _y, state.focused ? U8G2_BTN_INV : 0, 0, 1, 1, name);
+  // button adds padding and a frame around the text
+  _bbox = textBox(a, _y, textWidth(name), v_align, 2);
+}
+
+template <class Gfx>
+mui_event MuiItem_Gfx_ActionButton<Gfx>::muiEvent(mui_event e){
+  switch(e.eid){
+    // actions 'select' and 'enter' will trigger defined event
+    case mui_event_t::select :
+    case mui_event_t::enter :
+      return mui_event(_action);
+    default:
+      break;
+  }
+  return {};
+}
+
+
+template <class Gfx>
+void MuiItem_Gfx_DynamicScrollList<Gfx>::renderState(const MuiItem* parent, const mui_item_state& state){
+  // list size is requested only once per frame
+  const size_t size = _size_cb();
+  MUIPP_TRACE_V(list_render, id, size);
+  const int index = state.get<int>();
+
+  // specified cursor position will be the top reference for the Title text
+  useFontPos(text_align_t::top);
+
+  // rows are drawn with _font2 and highlighted row with _font, if _font is not defined highlighted row is drawn with _font2 as well,
+  // font already set is used only if _font2 is not defined
+  int row_h = _font2 ? 0 : _gfx.getMaxCharHeight();
+  for (auto f : {_font, _font2}){
+    if (!f) continue;
+    useFont(f);
+    row_h = std::max<int>(row_h, _gfx.getMaxCharHeight());
+  }
+  // list takes the rest of the screen width, rows are padded with inverted box
+  _bbox = mui_rect(_x - 2, _y - 2, _gfx.getDisplayWidth() - _x + 2, _y_shift*(_num_of_rows - 1) + row_h + 4);
+
+  if (!size)
+    return;
+
+  // normalize index position which items should be displayed
+  int visible_idx = muipp::clamp(index - _num_of_rows/2, 0, static_cast<int>(size - 1) );
+  _scroll(visible_idx, size);
+  for (int i = 0; i != _num_of_rows; ++i){
+    // change font for active/inactive row
+    if (visible_idx == index && _font)
+      useFont(_font);
+    else
+      useFont(_font2);
+
+    // draw button
+    MUIPP_TRACE_V(list_row, id, visible_idx);
+    _gfx.drawButtonUTF8(_x, _y + _y_shift*i, visible_idx == index ? U8G2_BTN_INV : 0, 0, 1, 1, _label(visible_idx));
+
+    if (++visible_idx >= static_cast<int>(size))
+      return;
+  }
+}
+
+template <class Gfx>
+void MuiItem_Gfx_DynamicScrollList<Gfx>::_scroll(int first, size_t size){
+  const uint32_t version = _version.load();
+  const int rows = static_cast<int>(_labels.size());
+  int shift = first - _first;
+
+  // data has changed, drop all labels
+  if (version != _cache_version || size != _cache_size || shift >= rows || shift <= -rows){
+    for (auto &l : _labels) l.fetched = false;
+    _cache_version = version;
+    _cache_size = size;
+  } else if (shift > 0){
+    // keep labels of the rows that are still visible
+    std::move(_labels.begin() + shift, _labels.end(), _labels.begin());
+    std::for_each(_labels.end() - shift, _labels.end(), [](row_label_t &l){ l.fetched = false; });
+  } else if (shift < 0){
+    std::move_backward(_labels.begin(), _labels.end() + shift, _labels.end());
+    std::for_each(_labels.begin(), _labels.begin() - shift, [](row_label_t &l){ l.fetched = false; });
+  }
+  _first = first;
+}
+
+template <class Gfx>
+const char* MuiItem_Gfx_DynamicScrollList<Gfx>::_label(int idx){
+  row_label_t &l = _labels[idx - _first];
+  if (!l.fetched){
+    // callback might return a pointer to a shared buffer, so label is copied
+    const char* text = _cb(idx);
+    size_t len = text ? strnlen(text, sizeof(l.text) - 1) : 0;
+    // do not cut multibyte UTF-8 char when truncating
+    if (text && text[len])
+      while (len && (static_cast<uint8_t>(text[len]) & 0xc0) == 0x80) --len;
+    if (len) std::memcpy(l.text, text, len);
+    l.text[len] = 0;
+    l.fetched = true;
+  }
+  return l.text;
+}
+
+
+template <class Gfx>
+mui_event MuiItem_Gfx_DynamicScrollList<Gfx>::muiEvent(mui_event e){
+  MUIPP_TRACE_D(list_event, id, static_cast<uint32_t>(e.eid));
+  const int prev = _index;
+  // list size is requested only once per event
+  const int size = static_cast<int>(_size_cb());
+  switch(e.eid){
+    // cursor actions - move to previous position in a list
+    case mui_event_t::moveUp :
+    case mui_event_t::moveLeft : {
+      if (_index)
+        --_index;
+      else
+        _index = size - 1;
+      break;
+    }
+    // cursor actions - move to next position in a list
+    case mui_event_t::moveDown :
+    case mui_event_t::moveRight : {
+      ++_index;
+      if (_index >= size)
+        _index = 0;
+      break;
+    }
+
+    // coalesced cursor actions - move by a number of positions in a list, wrapping around
+    case mui_event_t::step : {
+      if (!size) break;
+      int32_t i = (static_cast<int32_t>(_index) + e.param % size) % size;
+      _index = i < 0 ? i + size : i;
+      break;
+    }
+
+    case mui_event_t::enter : {
+      // if dynamic list works as page seletor, we will stich pages here
+      if (listopts.page_selector){
+        // last item in a list acts as "go to previous page"
+        if (listopts.back_on_last && (_index == size - 1))
+          return mui_event(mui_event_t::prevPage);
+        // switch to pre-resolved page id if it was bound to this index
+        else if (static_cast<size_t>(_index) < _pages.size() && _pages[_index])
+          return mui_event(mui_event_t::goPageByID, static_cast<int32_t>(_pages[_index]));
+        else  // otherwise - switch to page by it's label
+          return mui_event(mui_event_t::goPageByName, 0, static_cast<void*>(const_cast<char*>(_cb(_index))) );
+      }
+      // otherwise we call a callback function to decide next event action
+      if (_action)
+        _action(_index);
+      break;
+    }
+
+    // enter acts as escape to release selection
+    case mui_event_t::escape :
+      return mui_event(on_escape);
+    default:
+      break;
+  }
+
+  if (_index != prev)
+    invalidate();
+
+  return {};
+}
+
+template <class Gfx>
+void MuiItem_Gfx_DynamicScrollList<Gfx>::bindPage(size_t index, muiItemId page_id){
+  if (index >= _pages.size())
+    _pages.resize(index + 1);
+  _pages[index] = page_id;
+}
+
+//  ***
+//  MuiItem_Gfx_CheckBox
+
+template <class Gfx>
+void MuiItem_Gfx_CheckBox<Gfx>::renderState(const MuiItem* parent, const mui_item_state& state){
+  useFont(_font);
+  // specified cursor position will be the bottom reference for the Title text
+  useFontPos(text_align_t::bottom);
+
+  int8_t a = _gfx.getAscent();
+  _gfx.drawFrame(_x, _y-a, a, a);
+  // draw mark in a checkbox if value is true
+  if (state.get<bool>()){
+    a -= 4;
+    _gfx.drawBox(_x + 2, _y-a-2, a, a);
+    a += 4;   // not sure how this alignment works :(
+  }
+
+  u8g2_int_t w{0};
+  if (getName()){
+    w = textWidth(getName());
+    a += 4;       /* add gap between the checkbox and the text area */
+    _gfx.drawUTF8(_x + a, _y, getName());
+  }
+
+  muipp::drawButtonFrame(_gfx, _x, _y, state.focused ? U8G2_BTN_INV : 0, w+a, 1, 1);
+  _bbox = textBox(_x, _y, w + a, text_align_t::bottom, 2);
+}
+
+template <class Gfx>
+mui_event MuiItem_Gfx_CheckBox<Gfx>::muiEvent(mui_event e){
+  switch(e.eid){
+    case mui_event_t::enter : {
+      _v = !_v;
+      invalidate();
+      // call a callback function to submit a new box value
+      if (_action)
+        _action(_v);
+      break;
+    }
+    default:
+      break;
+  }
+  // by default, return noop
+  return {};
+}
+
+
+//  ***
+//  MuiItem_Gfx_ValuesList
+
+template <class Gfx>
+void MuiItem_Gfx_ValuesList<Gfx>::renderState(const MuiItem* parent, const mui_item_state& state){
+  useFont(_font);
+
+  // draw label
+  auto a = getXoffset(name);
+  const int lw = _gfx.drawUTF8(a, _y, name);
+  _bbox = textBox(a, _y, lw, v_align);
+
+  // value must be printed right after end of label, drawUTF8() does not move print cursor, so take label's width.
+  // Position is not stored, item members are owned by event task and render could run in other task
+  const u8g2_uint_t xval = _x == _xval ? a + lw : _xval;
+
+  // draw button - https://github.com/olikraus/u8g2/wiki/u8g2reference#drawbuttonutf8
+  u8g2_uint_t flags = 0;
+  if (state.selected)
+    flags |= U8G2_BTN_INV;
+  else if (state.focused)
+    flags |= U8G2_BTN_BW1;
+
+  //if (_val_align == text_align_t::center)
+  //  flags |= U8G2_BTN_HCENTER;
+
+  // calc cursor's offset for value
+  const char* s = _getCurrent();
+  auto vxoff = getXoffset(xval, _val_halign, v_align, s);
+  // draw button with frame or inversion
+  _gfx.drawButtonUTF8(vxoff, _y, flags, 0, 2, 2, s);
+  _bbox.unite(textBox(vxoff, _y, textWidth(s), v_align, 3));
+}
+
+template <class Gfx>
+mui_event MuiItem_Gfx_ValuesList<Gfx>::muiEvent(mui_event e){
+  switch(e.eid){
+    // cursor actions - decr value
+    case mui_event_t::moveUp :
+    case mui_event_t::moveLeft : 
+      _onPrev();
+      // value is provided by callback, assume it has changed
+      invalidate();
+      break;
+    // cursor actions - incr value
+    case mui_event_t::moveDown :
+    case mui_event_t::moveRight :
+      _onNext();
+      invalidate();
+      break;
+    // coalesced cursor actions - apply a number of incr/decr steps
+    case mui_event_t::step :
+      for (int32_t n = e.param; n > 0; --n) _onNext();
+      for (int32_t n = e.param; n < 0; ++n) _onPrev();
+      invalidate();
+      break;
+
+    // enter acts as escape to release selection
+    case mui_event_t::enter :
+      return mui_event(on_escape);
+    default:
+      break;
+  }
+
+  // by default, return noop
+  return {};
+}
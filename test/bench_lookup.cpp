@@ -0,0 +1,32 @@
+/*
+  id lookup cost as the menu grows
+  N items are spread over N/10 pages, then pages are switched and items are bound to pages by id
+*/
+#include <chrono>
+#include <cstdio>
+#include "muiplusplus.hpp"
+
+struct Dummy : MuiItem { using MuiItem::MuiItem; };
+
+int main(){
+  for (int n : {50, 200, 800, 3200}){
+    MuiPlusPlus m;
+    int npages = n/10;
+    std::vector<muiItemId> pages;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int p = 0; p < npages; ++p) pages.push_back(m.makePage("p"));
+    for (int i = 0; i < n; ++i) m.addMuippItem(new Dummy(m.nextIndex()), pages[i % npages]);
+    auto t1 = std::chrono::steady_clock::now();
+
+    const int iters = 20000;
+    volatile int r = 0;
+    for (int k = 0; k < iters; ++k) r += static_cast<int>(m.goPageId(pages[(k*7) % npages]));
+    auto t2 = std::chrono::steady_clock::now();
+    for (int k = 0; k < iters; ++k) r += static_cast<int>(m.addItemToPage((k*13) % n + 1, pages[(k*7) % npages]));
+    auto t3 = std::chrono::steady_clock::now();
+
+    auto us = [](auto a, auto b){ return std::chrono::duration<double, std::micro>(b - a).count(); };
+    printf("items=%5d build=%9.1fus goPageId=%7.3fus/op addItemToPage=%7.3fus/op\n", n, us(t0, t1), us(t1, t2)/iters, us(t2, t3)/iters);
+  }
+  return 0;
+}
@@ -0,0 +1,6 @@
+#pragma once
+#include <cstdio>
+#include <cstdlib>
+
+// minimal assertion for host tests, prints failed condition and stops the test with non-zero exit code
+#define CHECK(cond) do { if (!(cond)){ std::printf("%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); std::exit(1); } } while (0)
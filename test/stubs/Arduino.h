@@ -0,0 +1,20 @@
+#pragma once
+// host build stub of Arduino core, only what the library uses
+#include <cstdint>
+#include <cstdio>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <algorithm>
+class Print {
+public:
+  virtual ~Print(){}
+  virtual size_t write(uint8_t c){ return 1; }
+  size_t print(const char* s){ return s ? strlen(s) : 0; }
+  size_t println(const char* s = ""){ return print(s); }
+  template<typename... A> size_t printf(const char* f, A... a){ return 0; }
+};
+class HardwareSerial : public Print {};
+extern HardwareSerial Serial;
+inline unsigned long millis(){ return 0; }
+inline unsigned long micros(){ return 0; }
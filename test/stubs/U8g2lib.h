@@ -0,0 +1,94 @@
+#pragma once
+// host build stub of U8g2 library
+// drawing calls do nothing, it keeps a frame buffer and counts calls and bytes sent to display for tests
+#include <string>
+#include "Arduino.h"
+typedef uint8_t u8g2_uint_t;
+typedef int8_t u8g2_int_t;
+struct u8g2_struct;
+typedef u8g2_uint_t (*u8g2_font_calc_vref_fnptr)(struct u8g2_struct *u8g2);
+typedef void (*u8g2_draw_ll_hvline_cb)(struct u8g2_struct *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t len, uint8_t dir);
+typedef struct u8g2_struct {
+  const uint8_t *font;
+  u8g2_font_calc_vref_fnptr font_calc_vref;
+  uint8_t tile_buf_height;
+  uint8_t tile_curr_row;
+  u8g2_draw_ll_hvline_cb ll_hvline;
+  uint8_t *tile_buf_ptr;
+  u8g2_uint_t pixel_buf_width;
+  u8g2_uint_t pixel_buf_height;
+  u8g2_uint_t pixel_curr_row;
+} u8g2_t;
+extern "C" {
+u8g2_uint_t u8g2_font_calc_vref_font(u8g2_t *u8g2);
+u8g2_uint_t u8g2_font_calc_vref_bottom(u8g2_t *u8g2);
+u8g2_uint_t u8g2_font_calc_vref_top(u8g2_t *u8g2);
+u8g2_uint_t u8g2_font_calc_vref_center(u8g2_t *u8g2);
+void u8g2_ll_hvline_vertical_top_lsb(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t len, uint8_t dir);
+void u8g2_DrawButtonFrame(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, uint8_t flags, u8g2_uint_t text_width, u8g2_uint_t padding_h, u8g2_uint_t padding_v);
+void u8g2_UpdateDisplayArea(u8g2_t *u8g2, uint8_t  tx, uint8_t ty, uint8_t tw, uint8_t th);
+}
+#define U8G2_BTN_BW0 0x00
+#define U8G2_BTN_BW1 0x01
+#define U8G2_BTN_SHADOW1 0x11
+#define U8G2_BTN_INV 0x40
+#define U8G2_BTN_HCENTER 0x80
+class U8G2 : public Print {
+protected:
+  u8g2_t u8g2;
+  u8g2_uint_t tx, ty;
+public:
+  uint8_t fb[1024]{};
+  size_t bytes_sent{0}, area_calls{0};
+  U8G2(){ u8g2 = {}; u8g2.ll_hvline = u8g2_ll_hvline_vertical_top_lsb; u8g2.tile_buf_ptr = fb; u8g2.tile_buf_height = 8; }
+  u8g2_t *getU8g2(void) { return &u8g2; }
+  u8g2_uint_t getDisplayHeight(void) { return 64; }
+  u8g2_uint_t getDisplayWidth(void) { return 128; }
+  uint8_t *getBufferPtr(void) { return u8g2.tile_buf_ptr; }
+  uint8_t page_row{0}, page_h{8};
+  uint8_t getBufferTileHeight(void) { return page_h; }
+  uint8_t getBufferTileWidth(void) { return 16; }
+  uint8_t getBufferCurrTileRow(void) { return page_row; }
+  void clearBuffer(void) {}
+  void sendBuffer(void) { bytes_sent += sizeof(fb); }
+  void firstPage(void) { page_row = 0; }
+  uint8_t nextPage(void) { page_row += page_h; return page_row < 8; }
+  void updateDisplayArea(uint8_t tx, uint8_t ty, uint8_t tw, uint8_t th) { bytes_sent += tw*th*8; ++area_calls; }
+  void updateDisplay(void) {}
+  void setDrawColor(uint8_t color_index) {}
+  uint8_t getDrawColor(void) { return 1; }
+  void setBitmapMode(uint8_t is_transparent) {}
+  void setFontMode(uint8_t is_transparent) {}
+  void drawPixel(u8g2_uint_t x, u8g2_uint_t y) {}
+  void drawHLine(u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t w) {}
+  void drawVLine(u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t h) {}
+  void drawBox(u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t w, u8g2_uint_t h) {}
+  void drawFrame(u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t w, u8g2_uint_t h) {}
+  void drawXBM(u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t w, u8g2_uint_t h, const uint8_t *bitmap) {}
+  size_t font_calls{0};
+  void setFont(const uint8_t  *font) { ++font_calls; u8g2.font = font; }
+  void setFontPosBaseline(void) { u8g2.font_calc_vref = u8g2_font_calc_vref_font; }
+  void setFontPosBottom(void) { u8g2.font_calc_vref = u8g2_font_calc_vref_bottom; }
+  void setFontPosTop(void) { u8g2.font_calc_vref = u8g2_font_calc_vref_top; }
+  void setFontPosCenter(void) { u8g2.font_calc_vref = u8g2_font_calc_vref_center; }
+  u8g2_uint_t drawStr(u8g2_uint_t x, u8g2_uint_t y, const char *s) { return 0; }
+  // texts drawn with drawUTF8()/drawButtonUTF8() when logging is enabled, each one is followed by '|'
+  bool log_text{false};
+  std::string text_log;
+  u8g2_uint_t drawUTF8(u8g2_uint_t x, u8g2_uint_t y, const char *s) { if (log_text) text_log.append(s).push_back('|'); return 0; }
+  u8g2_uint_t drawGlyph(u8g2_uint_t x, u8g2_uint_t y, uint16_t encoding) { return 0; }
+  void drawButtonUTF8(u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t flags, u8g2_uint_t width, u8g2_uint_t padding_h, u8g2_uint_t padding_v, const char *text) { if (log_text) text_log.append(text).push_back('|'); }
+  u8g2_uint_t getStrWidth(const char *s) { return 0; }
+  size_t utf8w_calls{0};
+  u8g2_uint_t getUTF8Width(const char *s) { ++utf8w_calls; return strlen(s)*6; }
+  int8_t getAscent(void) { return 0; }
+  int8_t getDescent(void) { return 0; }
+  // max char height is taken from the font header, same offset as in u8g2 fonts
+  int8_t getMaxCharHeight(void) { return u8g2.font ? u8g2.font[10] : 0; }
+  int8_t getMaxCharWidth(void) { return 0; }
+  int8_t getFontAscent(void) { return 0; }
+  int8_t getFontDescent(void) { return 0; }
+  void setCursor(u8g2_uint_t x, u8g2_uint_t y) { tx = x; ty = y; }
+  u8g2_uint_t getCursorX() { return tx; }
+  u8g2_uint_t getCursorY() { return ty; }
+};
@@ -0,0 +1,12 @@
+// host build stubs implementation
+#include "U8g2lib.h"
+HardwareSerial Serial;
+extern "C" {
+u8g2_uint_t u8g2_font_calc_vref_font(u8g2_t *u8g2){return 0;}
+u8g2_uint_t u8g2_font_calc_vref_bottom(u8g2_t *u8g2){return 0;}
+u8g2_uint_t u8g2_font_calc_vref_top(u8g2_t *u8g2){return 0;}
+u8g2_uint_t u8g2_font_calc_vref_center(u8g2_t *u8g2){return 0;}
+void u8g2_ll_hvline_vertical_top_lsb(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t len, uint8_t dir){}
+void u8g2_DrawButtonFrame(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, uint8_t flags, u8g2_uint_t text_width, u8g2_uint_t padding_h, u8g2_uint_t padding_v){}
+void u8g2_UpdateDisplayArea(u8g2_t *u8g2, uint8_t  tx, uint8_t ty, uint8_t tw, uint8_t th){}
+}
@@ -0,0 +1,37 @@
+/*
+  items report screen area they cover
+*/
+#include "muipp_u8g2.hpp"
+#include "check.h"
+
+// fake fonts, only max char height in the header is used by the stub
+static uint8_t font_small[23], font_mid[23], font_big[23];
+
+int main(){
+  font_small[10] = 4; font_mid[10] = 10; font_big[10] = 14;
+  U8G2 u8g2;
+
+  // list area is computed with list fonts, not with a font left set by a previous item
+  {
+    MuiItem_U8g2_DynamicScrollList l(u8g2, 1, [](size_t i){ return "row"; }, [](){ return size_t(5); }, nullptr, 12, 3, 0, 0, font_mid, font_big);
+    u8g2.setFont(font_small);
+    l.render(nullptr);
+    CHECK(l.getBBox().h == 12*2 + 14 + 4);
+
+    // first font is not defined, highlighted row is drawn with the second font, font set before does not matter
+    MuiItem_U8g2_DynamicScrollList l2(u8g2, 2, [](size_t i){ return "row"; }, [](){ return size_t(5); }, nullptr, 12, 3, 0, 0, nullptr, font_mid);
+    u8g2.setFont(font_big);
+    l2.render(nullptr);
+    CHECK(l2.getBBox().x == -2 && l2.getBBox().y == -2);
+    CHECK(l2.getBBox().w == 128 + 2);
+    CHECK(l2.getBBox().h == 12*2 + 10 + 4);
+
+    // second font is not defined, other rows are drawn with the font set before
+    MuiItem_U8g2_DynamicScrollList l3(u8g2, 3, [](size_t i){ return "row"; }, [](){ return size_t(5); }, nullptr, 12, 3, 0, 0, font_small, nullptr);
+    u8g2.setFont(font_mid);
+    l3.render(nullptr);
+    CHECK(l3.getBBox().h == 12*2 + 10 + 4);
+  }
+
+  return 0;
+}
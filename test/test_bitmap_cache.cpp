@@ -0,0 +1,45 @@
+/*
+  muipp::BitmapCache capture and draw on u8g2 frame buffer
+  checks that previous buffer content is merged back after capture, that only item's own pixels are replayed,
+  and that displays derived from U8G2 (as all u8g2 constructors are) get the cache, while other backends do not
+*/
+#include <algorithm>
+#include "muipp_u8g2.hpp"
+#include "check.h"
+#include "testfont.h"
+
+// stands for any of U8G2_SSD1306_* classes
+class SSD1306 : public U8G2 {};
+
+int main(){
+  // capture keeps background and stores only what render callback has drawn
+  U8G2 u8g2;
+  muipp::BitmapCache c;
+  static const char key[] = "k";
+  u8g2.fb[10] = 0x81;
+  c.capture(u8g2, key, mui_rect(8, 0, 8, 8), [&u8g2](){ u8g2.fb[10] |= 0x18; u8g2.fb[11] = 0x01; });
+  CHECK(u8g2.fb[10] == 0x99 && u8g2.fb[11] == 0x01);
+
+  // replayed image is OR'ed into the buffer, background captured over is not restored
+  std::fill(std::begin(u8g2.fb), std::end(u8g2.fb), 0);
+  CHECK(c.draw(u8g2, key));
+  CHECK(u8g2.fb[10] == 0x18 && u8g2.fb[11] == 0x01);
+  CHECK(!c.draw(u8g2, "other"));
+
+  // derived display class uses the cache, text is drawn on first render and on capture only
+  SSD1306 oled;
+  oled.log_text = true;
+  MuiItem_Gfx_StaticText<SSD1306> txt(oled, 1, "Hi", test_font, 0, 10);
+  txt.setBitmapCache(true);
+  txt.render(nullptr);
+  CHECK(oled.text_log == "Hi|Hi|");
+  txt.render(nullptr);
+  txt.render(nullptr);
+  CHECK(oled.text_log == "Hi|Hi|");
+
+  // other backends never capture
+  muipp::FrameBuffer fb(64, 16);
+  c.capture(fb, key, mui_rect(0, 0, 8, 8), [](){});
+  CHECK(!c.draw(fb, key));
+  return 0;
+}
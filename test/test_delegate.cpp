@@ -0,0 +1,38 @@
+/*
+  muipp::delegate copy and move of trivially and non-trivially copyable callables
+*/
+#include <memory>
+#include <utility>
+#include "muipp_tpl.hpp"
+#include "check.h"
+
+int main(){
+  using fn_t = muipp::delegate<int (int)>;
+
+  // trivially copyable capture is copied as a block
+  int base = 10;
+  fn_t a = [&base](int v){ return base + v; };
+  fn_t b(a);
+  CHECK(b(1) == 11);
+  fn_t c(std::move(b));
+  CHECK(c(2) == 12);
+  CHECK(!b);
+
+  // non-trivially copyable capture is copied and moved with it's own constructors
+  auto p = std::make_shared<int>(5);
+  fn_t d = [p](int v){ return *p + v; };
+  CHECK(p.use_count() == 2);
+  fn_t e(d);
+  CHECK(p.use_count() == 3);
+  fn_t f(std::move(e));
+  CHECK(p.use_count() == 3);
+  CHECK(!e);
+  CHECK(f(1) == 6);
+  e = std::move(f);
+  CHECK(p.use_count() == 3);
+  CHECK(e(2) == 7);
+  d = nullptr;
+  e.reset();
+  CHECK(p.use_count() == 1);
+  return 0;
+}
@@ -0,0 +1,65 @@
+/*
+  events posted from another thread, built with ThreadSanitizer
+*/
+#include <atomic>
+#include <thread>
+#include "muiplusplus.hpp"
+#include "check.h"
+
+static std::atomic<int> focus_events{0};
+
+// item that counts focus events
+struct Probe : MuiItem {
+  using MuiItem::MuiItem;
+  mui_event muiEvent(mui_event e) override {
+    if (e.eid == mui_event_t::focus) ++focus_events;
+    return {};
+  }
+};
+
+int main(){
+  // queue keeps order and loses nothing between producer and consumer threads
+  {
+    muipp::spsc_queue<uint32_t, 16> q;
+    const uint32_t n = 100000;
+    std::thread producer([&q]{
+      for (uint32_t i = 0; i != n; ++i)
+        while (!q.push(i)) std::this_thread::yield();
+    });
+    uint32_t expected = 0, v;
+    bool ordered = true;
+    while (expected != n){
+      if (!q.pop(v)){ std::this_thread::yield(); continue; }
+      ordered &= v == expected++;
+    }
+    producer.join();
+    CHECK(ordered);
+    CHECK(q.empty());
+  }
+
+  // menu events posted by input thread are all handled by menu thread
+  {
+    MuiPlusPlus menu;
+    muiItemId page = menu.makePage("p");
+    for (int i = 0; i != 2; ++i)
+      menu.addMuippItem(new Probe(menu.nextIndex(), nullptr, item_opts{false, false}), page);
+    menu.menuStart(page);
+    focus_events = 0;
+
+    const int n = 5000;
+    std::atomic<bool> done{false};
+    std::thread input([&menu, &done]{
+      for (int i = 0; i != n; ++i)
+        while (!menu.postEvent(mui_event(mui_event_t::moveDown))) std::this_thread::yield();
+      done = true;
+    });
+    while (!done.load() || menu.eventsPending()){
+      menu.processEvents();
+      menu.needsRedraw();
+    }
+    input.join();
+    CHECK(focus_events.load() == n);
+  }
+
+  return 0;
+}
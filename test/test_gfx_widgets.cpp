@@ -0,0 +1,77 @@
+/*
+  widgets rendered into muipp::FrameBuffer backend
+*/
+#include <algorithm>
+#include <vector>
+#include "muipp_u8g2.hpp"
+#include "check.h"
+#include "testfont.h"
+
+// all lit pixels of the buffer lie within the rect
+static bool inside(const muipp::FrameBuffer &fb, const mui_rect& r){
+  for (int y = 0; y != fb.getDisplayHeight(); ++y)
+    for (int x = 0; x != fb.getDisplayWidth(); ++x)
+      if (fb.getPixel(x, y) && (x < r.x || y < r.y || x >= r.x + r.w || y >= r.y + r.h))
+        return false;
+  return true;
+}
+
+static size_t lit(const muipp::FrameBuffer &fb){
+  size_t n = 0;
+  for (int y = 0; y != fb.getDisplayHeight(); ++y)
+    for (int x = 0; x != fb.getDisplayWidth(); ++x)
+      n += fb.getPixel(x, y);
+  return n;
+}
+
+int main(){
+  muipp::FrameBuffer fb(64, 16);
+
+  // checkbox frame is drawn right above the bottom reference, label follows it with a gap
+  MuiItem_Gfx_CheckBox<muipp::FrameBuffer> cb(fb, 1, "A", false, nullptr, test_font, 2, 10);
+  cb.render(nullptr);
+  CHECK(fb.getPixel(2, 6) && fb.getPixel(5, 6) && fb.getPixel(2, 9) && fb.getPixel(5, 9));
+  CHECK(!fb.getPixel(3, 7));
+  // 'A' top row is .##. with baseline one pixel above the bottom reference
+  CHECK(!fb.getPixel(10, 5) && fb.getPixel(11, 5) && fb.getPixel(12, 5) && !fb.getPixel(13, 5));
+  CHECK(fb.getPixel(10, 8) && fb.getPixel(13, 8));
+  CHECK(inside(fb, cb.getBBox()));
+
+  // focused action button draws the same pixels as backend's own inverted button
+  fb.clearBuffer();
+  MuiItem_Gfx_ActionButton<muipp::FrameBuffer> btn(fb, 2, {mui_event_t::prevPage}, "Aa", test_font, 20, 8, text_align_t::center, text_align_t::center);
+  mui_item_state s = btn.getState();
+  s.focused = true;
+  btn.renderState(nullptr, s);
+  std::vector<uint8_t> drawn(fb.getBufferPtr(), fb.getBufferPtr() + fb.getBufferSize());
+  CHECK(lit(fb) > 0);
+  CHECK(inside(fb, btn.getBBox()));
+
+  muipp::FrameBuffer ref(64, 16);
+  ref.setFont(test_font);
+  ref.setFontPosCenter();
+  ref.drawButtonUTF8(20 - ref.getUTF8Width("Aa") / 2, 8, U8G2_BTN_INV, 0, 1, 1, "Aa");
+  CHECK(std::equal(drawn.begin(), drawn.end(), ref.getBufferPtr()));
+
+  // backend state is tracked through muipp::currentFont()/currentFontPos(), repeated render changes nothing
+  Item_Gfx_Generic<muipp::FrameBuffer>::resetStateStats();
+  fb.clearBuffer();
+  btn.renderState(nullptr, s);
+  CHECK(Item_Gfx_Generic<muipp::FrameBuffer>::stateStats().applied == 0);
+  CHECK(Item_Gfx_Generic<muipp::FrameBuffer>::stateStats().avoided > 0);
+  CHECK(std::equal(drawn.begin(), drawn.end(), fb.getBufferPtr()));
+
+  // value slider prints the value inverted between it's neighbours
+  fb.clearBuffer();
+  int32_t v = 5;
+  MuiItem_Gfx_NumberHSlide<int32_t, muipp::FrameBuffer> slide(fb, 3, "s", v, 0, 10, 1, nullptr, nullptr, nullptr, nullptr, test_font, test_font, 32, 8, 4);
+  slide.render(nullptr);
+  CHECK(lit(fb) > 0);
+  CHECK(inside(fb, slide.getBBox()));
+
+  // U8G2 names are aliases of the same templates
+  static_assert(std::is_same_v<MuiItem_U8g2_CheckBox, MuiItem_Gfx_CheckBox<U8G2>>);
+  static_assert(std::is_same_v<MuiItem_U8g2_NumberHSlide<float>, MuiItem_Gfx_NumberHSlide<float, U8G2>>);
+  static_assert(!muipp::is_gfx_backend_v<int>);
+  return 0;
+}
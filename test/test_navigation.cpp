@@ -0,0 +1,126 @@
+/*
+  focus navigation order on a page
+*/
+#include <vector>
+#include "muiplusplus.hpp"
+#include "check.h"
+
+static std::vector<muiItemId> focus_log;
+
+// item that records focus events, optionally passes focus on to the next item
+struct Probe : MuiItem {
+  bool pass{false};
+  // re-entrant call to menu's muiEvent() from focus handler, limited so that unbounded recursion ends
+  MuiPlusPlus* reenter{nullptr};
+  static inline int reentries{0};
+  using MuiItem::MuiItem;
+  mui_event muiEvent(mui_event e) override {
+    if (e.eid != mui_event_t::focus) return {};
+    focus_log.push_back(id);
+    if (reenter && ++reentries < 20)
+      reenter->muiEvent(mui_event(mui_event_t::moveDown));
+    return pass ? mui_event(mui_event_t::moveDown) : mui_event();
+  }
+};
+
+int main(){
+  // page with constant items at the start, in the middle and at the end
+  {
+    MuiPlusPlus m;
+    muiItemId p = m.makePage("p");
+    std::vector<muiItemId> ids;
+    for (int i = 0; i != 7; ++i){
+      ids.push_back(m.nextIndex());
+      m.addMuippItem(new Probe(ids.back(), nullptr, item_opts{false, i == 0 || i == 3 || i == 6}), p);
+    }
+    m.menuStart(p);
+    CHECK(focus_log == std::vector<muiItemId>({ids[1]}));
+
+    focus_log.clear();
+    for (int k = 0; k != 4; ++k) m.muiEvent(mui_event(mui_event_t::moveDown));
+    CHECK(focus_log == std::vector<muiItemId>({ids[2], ids[4], ids[5], ids[1]}));
+
+    focus_log.clear();
+    for (int k = 0; k != 4; ++k) m.muiEvent(mui_event(mui_event_t::moveUp));
+    CHECK(focus_log == std::vector<muiItemId>({ids[5], ids[4], ids[2], ids[1]}));
+  }
+
+  // moving back from the first item cycles to the last item on a page, it used to be skipped
+  {
+    focus_log.clear();
+    MuiPlusPlus m;
+    muiItemId p = m.makePage("p");
+    std::vector<muiItemId> ids;
+    for (int i = 0; i != 4; ++i){
+      ids.push_back(m.nextIndex());
+      m.addMuippItem(new Probe(ids.back(), nullptr, item_opts{false, false}), p);
+    }
+    m.menuStart(p);
+    m.muiEvent(mui_event(mui_event_t::moveUp));
+    m.muiEvent(mui_event(mui_event_t::moveUp));
+    CHECK(focus_log == std::vector<muiItemId>({ids[0], ids[3], ids[2]}));
+  }
+
+  // focus reply is handled the same way on every focus path
+  {
+    focus_log.clear();
+    MuiPlusPlus m;
+    muiItemId p = m.makePage("p");
+    std::vector<muiItemId> ids;
+    for (int i = 0; i != 3; ++i){
+      ids.push_back(m.nextIndex());
+      auto item = new Probe(ids.back(), nullptr, item_opts{false, false});
+      item->pass = i == 1;
+      m.addMuippItem(item, p);
+    }
+    m.menuStart(p);
+    m.muiEvent(mui_event(mui_event_t::moveDown));
+    CHECK(focus_log == std::vector<muiItemId>({ids[0], ids[1], ids[2]}));
+
+    focus_log.clear();
+    m.goItmId(ids[1]);
+    CHECK(focus_log == std::vector<muiItemId>({ids[1], ids[2]}));
+  }
+
+  // id 0 is "no item", i.e. what exhausted nextIndex() returns, such items are rejected
+  {
+    MuiPlusPlus m;
+    muiItemId p = m.makePage("p");
+    CHECK(m.addMuippItem(new Probe(0, nullptr), p) == mui_err_t::id_err);
+    CHECK(m.makeItem<Probe>(0, nullptr) == nullptr);
+    CHECK(m.addItemToPage(0, p) == mui_err_t::id_err);
+
+    // page has no items, focus is not moved anywhere
+    focus_log.clear();
+    m.menuStart(p);
+    m.muiEvent(mui_event(mui_event_t::moveDown));
+    CHECK(focus_log.empty());
+  }
+
+  // events sent to the menu from item's handler are queued behind pending replies and share the budget of the outer call
+  {
+    MuiPlusPlus m;
+    muiItemId p = m.makePage("p");
+    std::vector<Probe*> probes;
+    for (int i = 0; i != 3; ++i){
+      probes.push_back(new Probe(m.nextIndex(), nullptr, item_opts{false, false}));
+      m.addMuippItem(probes.back(), p);
+    }
+    m.menuStart(p);
+    for (auto i : probes) i->reenter = &m;
+    m.setEventBudget(2);
+
+    focus_log.clear();
+    m.muiEvent(mui_event(mui_event_t::moveDown));
+    CHECK(focus_log == std::vector<muiItemId>({probes[1]->id, probes[2]->id}));
+    CHECK(Probe::reentries == 2);
+
+    // draining is over, direct calls are handled right away
+    for (auto i : probes) i->reenter = nullptr;
+    focus_log.clear();
+    m.goItmId(probes[0]->id);
+    CHECK(focus_log == std::vector<muiItemId>({probes[0]->id}));
+  }
+
+  return 0;
+}
@@ -0,0 +1,71 @@
+/*
+  NumberHSlide value stepping stays within bounds
+*/
+#include "muipp_u8g2.hpp"
+#include "check.h"
+
+template <typename T>
+static T step(MuiItem_U8g2_NumberHSlide<T> &s, int32_t count){
+  s.muiEvent(mui_event(mui_event_t::step, count));
+  return s.getState().template get<T>();
+}
+
+int main(){
+  U8G2 u8g2;
+
+  // unsigned value must not wrap around below min or above max
+  {
+    uint16_t v = 3;
+    MuiItem_U8g2_NumberHSlide<uint16_t> s(u8g2, 1, "s", v, 0, 100, 2);
+    CHECK(step(s, -1) == 1);
+    CHECK(step(s, -5) == 0);
+    s.muiEvent(mui_event(mui_event_t::moveUp));
+    CHECK(v == 0);
+    CHECK(step(s, 20) == 40);
+    CHECK(step(s, 1000000) == 100);
+    s.muiEvent(mui_event(mui_event_t::moveDown));
+    CHECK(v == 100);
+    CHECK(step(s, -49) == 2);
+  }
+
+  // step * count must not overflow a narrow type
+  {
+    uint8_t v = 250;
+    MuiItem_U8g2_NumberHSlide<uint8_t> s(u8g2, 2, "s", v, 10, 255, 5);
+    CHECK(step(s, 100) == 255);
+    CHECK(step(s, -100) == 10);
+    CHECK(step(s, 3) == 25);
+  }
+
+  // signed and floating point values
+  {
+    int32_t v = 0;
+    MuiItem_U8g2_NumberHSlide<int32_t> s(u8g2, 3, "s", v, -10, 10, 3);
+    CHECK(step(s, -2) == -6);
+    CHECK(step(s, -2) == -10);
+    CHECK(step(s, 7) == 10);
+
+    float f = 0.5f;
+    MuiItem_U8g2_NumberHSlide<float> sf(u8g2, 4, "f", f, 0, 1, 0.25f);
+    CHECK(step(sf, -3) == 0.0f);
+    CHECK(step(sf, 3) == 0.75f);
+  }
+
+  // neighbour values are not drawn beyond the range, unsigned value must not wrap around
+  {
+    uint32_t v = 0;
+    MuiItem_U8g2_NumberHSlide<uint32_t> s(u8g2, 5, "s", v, 0, 100, 5);
+    u8g2.log_text = true;
+    s.render(nullptr);
+    CHECK(u8g2.text_log == "0|5|");
+
+    uint32_t w = 0xfffffffe;
+    MuiItem_U8g2_NumberHSlide<uint32_t> sw(u8g2, 6, "s", w, 0xfffffff0, 0xffffffff, 5);
+    u8g2.text_log.clear();
+    sw.render(nullptr);
+    CHECK(u8g2.text_log == "4294967289|4294967294|");
+    u8g2.log_text = false;
+  }
+
+  return 0;
+}
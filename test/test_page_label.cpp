@@ -0,0 +1,39 @@
+/*
+  page lookup by label after pages are renamed
+*/
+#include "muiplusplus.hpp"
+#include "check.h"
+
+// item that keeps a pointer to the page it was rendered on
+struct Probe : MuiItem {
+  using MuiItem::MuiItem;
+  const MuiItem* page{nullptr};
+  void render(const MuiItem* parent) override { page = parent; }
+};
+
+int main(){
+  MuiPlusPlus m;
+  muiItemId a = m.makePage("a");
+  muiItemId b = m.makePage("b");
+  CHECK(m.pageIdByLabel("a") == a);
+  CHECK(m.pageIdByLabel("b") == b);
+  CHECK(m.pageIdByLabel("x") == 0);
+
+  // renamed through the container, index is updated
+  CHECK(m.setPageName(a, "x") == mui_err_t::ok);
+  CHECK(m.pageIdByLabel("x") == a);
+  CHECK(m.pageIdByLabel("a") == 0);
+  CHECK(m.setPageName(100, "y") == mui_err_t::id_err);
+
+  // renamed on the page object, indexed label is stale, current name is still found
+  Probe* probe = m.makeItem<Probe>(m.nextIndex(), nullptr);
+  m.addItemToPage(probe->id, b);
+  m.goPageId(b);
+  m.render();
+  CHECK(probe->page != nullptr);
+  const_cast<MuiItem*>(probe->page)->setName("y");
+  CHECK(m.pageIdByLabel("y") == b);
+  CHECK(m.pageIdByLabel("b") == 0);
+  CHECK(m.goPageLbl("y") == mui_err_t::ok);
+  return 0;
+}
@@ -0,0 +1,51 @@
+/*
+  NumberHSlide rendering does not allocate memory
+*/
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include "muipp_u8g2.hpp"
+#include "check.h"
+
+static size_t allocs = 0;
+
+void* operator new(size_t size){
+  ++allocs;
+  if (void* p = std::malloc(size ? size : 1)) return p;
+  throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+// render item a number of times, returns allocations made
+static size_t render(MuiItem &item, int times){
+  size_t before = allocs;
+  for (int i = 0; i != times; ++i){
+    item.render(nullptr);
+    item.muiEvent(mui_event(i & 1 ? mui_event_t::moveUp : mui_event_t::moveDown));
+  }
+  return allocs - before;
+}
+
+int main(){
+  U8G2 u8g2;
+
+  int32_t iv = 123456789;
+  MuiItem_U8g2_NumberHSlide<int32_t> islide(u8g2, 1, "i", iv, -2000000000, 2000000000, 1000);
+
+  float fv = 3.25f;
+  MuiItem_U8g2_NumberHSlide<float> fslide(u8g2, 2, "f", fv, 0, 10, 0.25f);
+
+  // user formatter producing a string longer than std::string small buffer
+  uint32_t uv = 50;
+  MuiItem_U8g2_NumberHSlide<uint32_t> uslide(u8g2, 3, "u", uv, 0, 100, 1,
+    [](uint32_t v, char* buff, size_t size) -> size_t { return std::snprintf(buff, size, "temperature %u C", static_cast<unsigned>(v)); });
+
+  // warm up, first render may fill caches
+  render(islide, 1); render(fslide, 1); render(uslide, 1);
+
+  CHECK(render(islide, 1000) == 0);
+  CHECK(render(fslide, 1000) == 0);
+  CHECK(render(uslide, 1000) == 0);
+  return 0;
+}
@@ -0,0 +1,49 @@
+/*
+  RenderScheduler event processing and replies, built with ThreadSanitizer
+*/
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "muipp_scheduler.hpp"
+#include "check.h"
+
+static std::atomic<int> frames{0}, quits{0};
+
+struct Probe : MuiItem { using MuiItem::MuiItem; };
+
+// wait until render task draws specified number of frames
+static bool wait_frames(int n){
+  for (int i = 0; i != 1000 && frames.load() < n; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  return frames.load() >= n;
+}
+
+int main(){
+  MuiPlusPlus menu;
+  muiItemId page = menu.makePage("p");
+  muiItemId a = menu.nextIndex(), b = menu.nextIndex();
+  menu.addMuippItem(new Probe(a, nullptr, item_opts{false, false}), page);
+  Probe* pb = new Probe(b, nullptr, item_opts{false, false});
+  menu.addMuippItem(pb, page);
+  menu.menuStart(page);
+
+  muipp::RenderScheduler s(menu, [](){ ++frames; }, 0, [](mui_event e){ if (e.eid == mui_event_t::quitMenu) ++quits; });
+  std::thread t([&s]{ s.run(); });
+
+  // first frame is always drawn
+  CHECK(wait_frames(1));
+
+  // escape on a root page replies with quitMenu, events queued after it must not be left in the queue
+  s.postEvent(mui_event(mui_event_t::escape));
+  s.postEvent(mui_event(mui_event_t::moveDown));
+  CHECK(wait_frames(2));
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+  s.stop();
+  t.join();
+
+  CHECK(quits.load() == 1);
+  CHECK(!menu.eventsPending());
+  CHECK(pb->focused);
+  return 0;
+}
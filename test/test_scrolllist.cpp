@@ -0,0 +1,69 @@
+/*
+  DynamicScrollList label and size caching
+*/
+#include <cstdio>
+#include "muipp_u8g2.hpp"
+#include "check.h"
+
+static int label_calls = 0, size_calls = 0;
+static size_t list_size = 8;
+
+// label callback that prints into a single shared buffer
+static const char* label(size_t i){
+  static char buff[16];
+  ++label_calls;
+  std::snprintf(buff, sizeof(buff), "row%u", static_cast<unsigned>(i));
+  return buff;
+}
+
+static size_t count(){ ++size_calls; return list_size; }
+
+static std::string frame(U8G2 &u8g2, MuiItem &l){
+  u8g2.text_log.clear();
+  l.render(nullptr);
+  return u8g2.text_log;
+}
+
+int main(){
+  U8G2 u8g2;
+  u8g2.log_text = true;
+  MuiItem_U8g2_DynamicScrollList l(u8g2, 1, label, count, nullptr, 10, 3);
+
+  // labels from a shared buffer are kept per row
+  CHECK(frame(u8g2, l) == "row0|row1|row2|");
+  CHECK(label_calls == 3 && size_calls == 1);
+
+  // cached rows do not call label callback again
+  label_calls = size_calls = 0;
+  CHECK(frame(u8g2, l) == "row0|row1|row2|");
+  CHECK(label_calls == 0 && size_calls == 1);
+
+  // scrolling fetches only rows that came into view
+  label_calls = 0;
+  for (int i = 0; i != 3; ++i) l.muiEvent(mui_event(mui_event_t::moveDown));
+  CHECK(frame(u8g2, l) == "row2|row3|row4|");
+  CHECK(label_calls == 2);
+  l.muiEvent(mui_event(mui_event_t::moveUp));
+  label_calls = 0;
+  CHECK(frame(u8g2, l) == "row1|row2|row3|");
+  CHECK(label_calls == 1);
+
+  // refresh and data version drop the cache
+  label_calls = 0;
+  l.refresh();
+  frame(u8g2, l);
+  CHECK(label_calls == 3);
+  l.setVersion(7);
+  frame(u8g2, l);
+  l.setVersion(7);
+  frame(u8g2, l);
+  CHECK(label_calls == 6);
+
+  // list size change drops the cache as well
+  label_calls = 0;
+  list_size = 3;
+  CHECK(frame(u8g2, l) == "row1|row2|");
+  CHECK(label_calls == 2);
+
+  return 0;
+}
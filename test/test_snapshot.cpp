@@ -0,0 +1,72 @@
+/*
+  render snapshots with events and rendering in different threads, built with ThreadSanitizer
+  event thread navigates a page of probes and real widgets while main thread renders from published snapshots,
+  each frame must be drawn from a consistent state (exactly one focused item) and render must not touch
+  item state owned by event thread
+*/
+#include <atomic>
+#include <thread>
+#include "muipp_u8g2.hpp"
+#include "check.h"
+
+// focused items seen while rendering a frame
+static int focused_in_frame = 0;
+
+// item that checks render state it gets
+struct Probe : MuiItem {
+  using MuiItem::MuiItem;
+  void renderState(const MuiItem* parent, const mui_item_state& state) override { focused_in_frame += state.focused; }
+};
+
+// real widget that also counts it's focus
+template <class W>
+struct Counted : W {
+  using W::W;
+  void renderState(const MuiItem* parent, const mui_item_state& state) override {
+    focused_in_frame += state.focused;
+    W::renderState(parent, state);
+  }
+};
+
+static const char* label(size_t i){ static const char* l[] = {"a", "b", "c", "d"}; return l[i]; }
+
+int main(){
+  U8G2 u8g2;
+  MuiPlusPlus m;
+  muiItemId page = m.makePage("p");
+  int32_t value = 0;
+  for (int i = 0; i != 3; ++i)
+    m.addItemToPage(m.makeItem<Probe>(m.nextIndex(), nullptr, item_opts{false, false})->id, page);
+  m.addItemToPage(m.makeItem<Counted<MuiItem_U8g2_CheckBox>>(u8g2, m.nextIndex(), "cb", false)->id, page);
+  m.addItemToPage(m.makeItem<Counted<MuiItem_U8g2_NumberHSlide<int32_t>>>(u8g2, m.nextIndex(), "s", value, 0, 1000, 1)->id, page);
+  m.addItemToPage(m.makeItem<Counted<MuiItem_U8g2_DynamicScrollList>>(u8g2, m.nextIndex(), label, [](){ return size_t(4); }, nullptr, 10)->id, page);
+  // value list is placed right after it's label, that position is computed on render
+  static const char* current = "v";
+  m.addItemToPage(m.makeItem<Counted<MuiItem_U8g2_ValuesList>>(u8g2, m.nextIndex(), "vl", [](){ return current; }, [](){}, [](){}, 0, 0, 20)->id, page);
+  m.menuStart(page);
+  m.setSnapshotMode(true);
+
+  std::atomic<bool> done{false};
+  std::thread events([&m, &done]{
+    const mui_event_t e[] = {mui_event_t::moveDown, mui_event_t::enter, mui_event_t::moveDown, mui_event_t::enter};
+    for (int i = 0; i != 20000; ++i){
+      m.postEvent(mui_event(e[i % 4]));
+      m.processEvents();
+    }
+    done = true;
+  });
+
+  // every frame is drawn from a consistent state, exactly one item on a page has focus
+  int frames = 0, bad_frames = 0;
+  while (!done.load()){
+    focused_in_frame = 0;
+    m.render();
+    bad_frames += focused_in_frame != 1;
+    ++frames;
+  }
+  events.join();
+
+  CHECK(frames > 0);
+  CHECK(bad_frames == 0);
+  return 0;
+}
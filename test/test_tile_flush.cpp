@@ -0,0 +1,54 @@
+/*
+  bytes sent to display by TileFlusher and flushArea()
+  stub display counts bytes passed to sendBuffer()/updateDisplayArea() and number of area updates,
+  so the test checks that only changed 8x8 tiles are transferred and how changed tiles are merged into spans
+*/
+#include "muipp_u8g2.hpp"
+#include "check.h"
+
+// 128x64 stub buffer, 16 tiles in a row, 8 bytes per tile
+static uint8_t& tile_byte(U8G2 &u8g2, int tx, int ty, int b = 0){ return u8g2.fb[ty * 128 + tx * 8 + b]; }
+
+int main(){
+  U8G2 u8g2;
+  muipp::TileFlusher f(u8g2);
+
+  // first flush sends the whole buffer
+  CHECK(f.flush() == 128);
+  CHECK(u8g2.bytes_sent == 1024);
+
+  // nothing changed, nothing is sent
+  u8g2.bytes_sent = u8g2.area_calls = 0;
+  CHECK(f.flush() == 0);
+  CHECK(u8g2.bytes_sent == 0);
+  CHECK(u8g2.area_calls == 0);
+
+  // adjacent tiles are sent in one span, distant tiles and other rows in their own spans
+  tile_byte(u8g2, 3, 2, 1) = 1;
+  tile_byte(u8g2, 4, 2, 7) = 1;
+  tile_byte(u8g2, 10, 2) = 1;
+  tile_byte(u8g2, 0, 7) = 0xff;
+  CHECK(f.flush() == 4);
+  CHECK(u8g2.bytes_sent == 32);
+  CHECK(u8g2.area_calls == 3);
+
+  // a gap of one unchanged tile is sent anyway to join two spans
+  u8g2.bytes_sent = u8g2.area_calls = 0;
+  tile_byte(u8g2, 3, 5) = 1;
+  tile_byte(u8g2, 5, 5) = 1;
+  CHECK(f.flush() == 3);
+  CHECK(u8g2.bytes_sent == 24);
+  CHECK(u8g2.area_calls == 1);
+
+  // after reset whole buffer is sent again
+  u8g2.bytes_sent = 0;
+  f.reset();
+  CHECK(f.flush() == 128);
+  CHECK(u8g2.bytes_sent == 1024);
+
+  // area sends tiles covering it: x 5..14 and y 5..8 span 2x2 tiles
+  u8g2.bytes_sent = 0;
+  CHECK(muipp::flushArea(u8g2, mui_rect(5, 5, 10, 4)) == 4);
+  CHECK(u8g2.bytes_sent == 32);
+  return 0;
+}
@@ -0,0 +1,45 @@
+/*
+  trace ring buffer read while other threads record, built with ThreadSanitizer and tracing enabled
+*/
+#include <atomic>
+#include <thread>
+#include "muipp_trace.hpp"
+#include "check.h"
+
+using muipp::trace_point_t;
+
+int main(){
+  std::atomic<bool> done{false};
+  // each writer uses it's own trace point and item id, argument is a sequence number
+  auto writer = [](trace_point_t point, muiItemId item){
+    for (uint32_t i = 0; i != 20000; ++i)
+      muipp::trace::record(point, item, i);
+  };
+  std::thread w1(writer, trace_point_t::item_add, 1);
+  std::thread w2(writer, trace_point_t::page_make, 2);
+  std::thread reader([&done]{
+    muipp::trace_record_t r[MUIPP_TRACE_BUFFER_SIZE];
+    size_t bad = 0;
+    while (!done.load()){
+      size_t n = muipp::trace::read(r, MUIPP_TRACE_BUFFER_SIZE);
+      // a record mixed from two writes would not match it's writer
+      for (size_t i = 0; i != n; ++i)
+        bad += !((r[i].item == 1 && r[i].point == trace_point_t::item_add) || (r[i].item == 2 && r[i].point == trace_point_t::page_make));
+    }
+    CHECK(bad == 0);
+  });
+  w1.join();
+  w2.join();
+  done = true;
+  reader.join();
+
+  // all records are complete once writers are done
+  muipp::trace_record_t r[MUIPP_TRACE_BUFFER_SIZE];
+  CHECK(muipp::trace::read(r, MUIPP_TRACE_BUFFER_SIZE) == MUIPP_TRACE_BUFFER_SIZE);
+  muipp::trace::clear();
+  CHECK(muipp::trace::read(r, MUIPP_TRACE_BUFFER_SIZE) == 0);
+  muipp::trace::record(trace_point_t::item_dtor, 7, 3);
+  CHECK(muipp::trace::read(r, MUIPP_TRACE_BUFFER_SIZE) == 1);
+  CHECK(r[0].item == 7 && r[0].point == trace_point_t::item_dtor && r[0].arg == 3);
+  return 0;
+}
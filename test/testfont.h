@@ -0,0 +1,12 @@
+#pragma once
+#include <cstdint>
+/*
+  tiny font in u8g2 format for FrameBuffer tests, ascent 4, descent -1, max char height 5
+  glyphs (x advance):
+    ' ' (3)
+    'A' (5)  .##.   'a' (5)  .##    U+041F (6)  ####
+             #..#            #.#                #..#
+             ####            .##  1px below     #..#
+             #..#                 baseline      #..#
+*/
+const uint8_t test_font[] = {4,0,3,3,4,4,2,2,4,4,5,0,255,4,255,4,255,0,5,0,14,0,24,32,5,0,186,0,65,9,68,218,145,132,76,1,0,97,8,51,214,153,68,4,0,0,0,0,4,255,255,4,31,10,68,235,40,137,68,1,0,0,0};